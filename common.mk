@@ -103,6 +103,10 @@ endif
 ifeq ($(MCL_USE_OPENSSL),1)
   OPENSSL_LIB=-lcrypto
 endif
+ifeq ($(MCL_USE_OMP),1)
+  CFLAGS+=-DMCL_USE_OMP -fopenmp
+  LDFLAGS+=-fopenmp
+endif
 LDFLAGS+=$(GMP_LIB) $(OPENSSL_LIB) $(BIT_OPT) $(LDFLAGS_USER)
 
 CFLAGS+=-fPIC
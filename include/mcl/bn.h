@@ -114,7 +114,7 @@ MCLBN_DLL_API int mclBn_init(int curve, int maxUnitSize);
 	serialized size of elements
 	|Fr| = |G1| = 32 bytes (if CurveFp254BNb), 48 bytes (if CurevFp382_{1,2}), 58 bytes (if CurveFp462)
 	|G2| = |G1| * 2
-	|GT| = |G1| * 12
+	|GT| = |G1| * 12 (|G1| * 6 by mclBnGT_serializeTorus)
 */
 /*
 	return the num of Unit(=uint64_t) to store Fr
@@ -188,6 +188,12 @@ MCLBN_DLL_API void mclBnFr_add(mclBnFr *z, const mclBnFr *x, const mclBnFr *y);
 MCLBN_DLL_API void mclBnFr_sub(mclBnFr *z, const mclBnFr *x, const mclBnFr *y);
 MCLBN_DLL_API void mclBnFr_mul(mclBnFr *z, const mclBnFr *x, const mclBnFr *y);
 MCLBN_DLL_API void mclBnFr_div(mclBnFr *z, const mclBnFr *x, const mclBnFr *y);
+/*
+	y[i] = 1 / x[i] for i in [0, n) by one inversion
+	y[i] = 0 if x[i] = 0
+	y may be equal to x
+*/
+MCLBN_DLL_API void mclBnFr_invVec(mclBnFr *y, const mclBnFr *x, mclSize n);
 
 ////////////////////////////////////////////////
 // set zero
@@ -221,6 +227,11 @@ MCLBN_DLL_API void mclBnG1_mul(mclBnG1 *z, const mclBnG1 *x, const mclBnFr *y);
 */
 MCLBN_DLL_API void mclBnG1_mulCT(mclBnG1 *z, const mclBnG1 *x, const mclBnFr *y);
 
+/*
+	z = sum_{i=0}^{n-1} x[i] * y[i]
+*/
+MCLBN_DLL_API void mclBnG1_mulVec(mclBnG1 *z, const mclBnG1 *x, const mclBnFr *y, mclSize n);
+
 ////////////////////////////////////////////////
 // set zero
 MCLBN_DLL_API void mclBnG2_clear(mclBnG2 *x);
@@ -252,6 +263,11 @@ MCLBN_DLL_API void mclBnG2_mul(mclBnG2 *z, const mclBnG2 *x, const mclBnFr *y);
 */
 MCLBN_DLL_API void mclBnG2_mulCT(mclBnG2 *z, const mclBnG2 *x, const mclBnFr *y);
 
+/*
+	z = sum_{i=0}^{n-1} x[i] * y[i]
+*/
+MCLBN_DLL_API void mclBnG2_mulVec(mclBnG2 *z, const mclBnG2 *x, const mclBnFr *y, mclSize n);
+
 ////////////////////////////////////////////////
 // set zero
 MCLBN_DLL_API void mclBnGT_clear(mclBnGT *x);
@@ -272,6 +288,14 @@ MCLBN_DLL_API int mclBnGT_isOne(const mclBnGT *x);
 MCLBN_DLL_API mclSize mclBnGT_getStr(char *buf, mclSize maxBufSize, const mclBnGT *x, int ioMode);
 // return written size if sucess else 0
 MCLBN_DLL_API mclSize mclBnGT_serialize(void *buf, mclSize maxBufSize, const mclBnGT *x);
+/*
+	6 Fp values by the torus representation ; half of mclBnGT_serialize
+	x must be in the cyclotomic subgroup (the value of pairing and its powers)
+	return written size if sucess else 0
+*/
+MCLBN_DLL_API mclSize mclBnGT_serializeTorus(void *buf, mclSize maxBufSize, const mclBnGT *x);
+// read the output of mclBnGT_serializeTorus ; return read size if success else 0
+MCLBN_DLL_API mclSize mclBnGT_deserializeTorus(mclBnGT *x, const void *buf, mclSize bufSize);
 
 MCLBN_DLL_API void mclBnGT_neg(mclBnGT *y, const mclBnGT *x);
 MCLBN_DLL_API void mclBnGT_inv(mclBnGT *y, const mclBnGT *x);
@@ -280,6 +304,8 @@ MCLBN_DLL_API void mclBnGT_add(mclBnGT *z, const mclBnGT *x, const mclBnGT *y);
 MCLBN_DLL_API void mclBnGT_sub(mclBnGT *z, const mclBnGT *x, const mclBnGT *y);
 MCLBN_DLL_API void mclBnGT_mul(mclBnGT *z, const mclBnGT *x, const mclBnGT *y);
 MCLBN_DLL_API void mclBnGT_div(mclBnGT *z, const mclBnGT *x, const mclBnGT *y);
+// same as mclBnFr_invVec
+MCLBN_DLL_API void mclBnGT_invVec(mclBnGT *y, const mclBnGT *x, mclSize n);
 
 /*
 	pow for all elements of Fp12
@@ -294,6 +320,11 @@ MCLBN_DLL_API void mclBnGT_pow(mclBnGT *z, const mclBnGT *x, const mclBnFr *y);
 MCLBN_DLL_API void mclBn_pairing(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y);
 MCLBN_DLL_API void mclBn_finalExp(mclBnGT *y, const mclBnGT *x);
 MCLBN_DLL_API void mclBn_millerLoop(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y);
+/*
+	z = prod_{i=0}^{n-1} millerLoop(x[i], y[i])
+	mclBn_finalExp(z, z) gives prod_{i=0}^{n-1} pairing(x[i], y[i])
+*/
+MCLBN_DLL_API void mclBn_millerLoopVec(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y, mclSize n);
 
 // return precomputedQcoeffSize * sizeof(Fp6) / sizeof(uint64_t)
 MCLBN_DLL_API int mclBn_getUint64NumToPrecompute(void);
@@ -303,6 +334,10 @@ MCLBN_DLL_API void mclBn_precomputeG2(uint64_t *Qbuf, const mclBnG2 *Q);
 
 MCLBN_DLL_API void mclBn_precomputedMillerLoop(mclBnGT *f, const mclBnG1 *P, const uint64_t *Qbuf);
 MCLBN_DLL_API void mclBn_precomputedMillerLoop2(mclBnGT *f, const mclBnG1 *P1, const uint64_t *Q1buf, const mclBnG1 *P2, const uint64_t *Q2buf);
+/*
+	f = prod_{i=0}^{n-1} precomputedMillerLoop(P[i], Qbuf + i * mclBn_getUint64NumToPrecompute())
+*/
+MCLBN_DLL_API void mclBn_precomputedMillerLoopVec(mclBnGT *f, const mclBnG1 *P, const uint64_t *Qbuf, mclSize n);
 
 /*
 	Lagrange interpolation
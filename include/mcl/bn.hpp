@@ -9,6 +9,10 @@
 #include <mcl/fp_tower.hpp>
 #include <mcl/ec.hpp>
 #include <assert.h>
+#include <new>
+#ifdef MCL_USE_OMP
+#include <omp.h>
+#endif
 
 namespace mcl { namespace bn {
 
@@ -49,6 +53,9 @@ inline const CurveParam& getCurveParam(int type)
 	}
 }
 
+template<class G2>
+struct HaveFrobenius;
+
 template<class Fp>
 struct MapToT {
 	typedef mcl::Fp2T<Fp> Fp2;
@@ -57,9 +64,11 @@ struct MapToT {
 	Fp c1; // sqrt(-3)
 	Fp c2; // (-1 + sqrt(-3)) / 2
 	mpz_class cofactor;
+	mpz_class z;
+	std::vector<int8_t> zReplTbl; // repl of abs(z) from the top
 	int legendre(const Fp& x) const
 	{
-		return gmp::legendre(x.getMpz(), Fp::getOp().mp);
+		return Fp::legendre(x);
 	}
 	int legendre(const Fp2& x) const
 	{
@@ -96,6 +105,8 @@ struct MapToT {
 			case 2: F::sqr(x, w); F::inv(x, x); *x.getFp0() += Fp::one(); break;
 			}
 			G::getWeierstrass(y, x);
+			// squareRoot is much slower than legendre for a non quadratic residue
+			if (legendre(y) < 0) continue;
 			if (F::squareRoot(y, y)) {
 				if (negative) F::neg(y, y);
 				P.set(x, y, false);
@@ -107,12 +118,44 @@ struct MapToT {
 	}
 	/*
 		cofactor is for G2
+		z is the parameter of the BN curve
 	*/
-	void init(const mpz_class& cofactor)
+	void init(const mpz_class& cofactor, const mpz_class& z)
 	{
 		if (!Fp::squareRoot(c1, -3)) throw cybozu::Exception("MapToT:init:c1");
 		c2 = (c1 - 1) / 2;
 		this->cofactor = cofactor;
+		this->z = z;
+		gmp::getNAF(zReplTbl, gmp::abs(z));
+	}
+	/*
+		Q = z P
+	*/
+	void mulByZ(G2& Q, const G2& P) const
+	{
+		const G2 T = P;
+		Q = T;
+		for (size_t i = 1; i < zReplTbl.size(); i++) {
+			G2::dbl(Q, Q);
+			if (zReplTbl[i] > 0) {
+				G2::add(Q, Q, T);
+			} else if (zReplTbl[i] < 0) {
+				G2::sub(Q, Q, T);
+			}
+		}
+		if (z < 0) G2::neg(Q, Q);
+	}
+	/*
+		Q = 6z^2 P
+	*/
+	void mulBy6z2(G2& Q, const G2& P) const
+	{
+		G2 T;
+		mulByZ(Q, P);
+		mulByZ(Q, Q);
+		G2::dbl(T, Q);
+		G2::add(Q, Q, T);
+		G2::dbl(Q, Q);
 	}
 	/*
 		P.-A. Fouque and M. Tibouchi,
@@ -126,6 +169,26 @@ struct MapToT {
 		calc<G1, Fp>(P, t);
 		assert(P.isValid());
 	}
+	/*
+		Q = cofactor * P for P in E'(Fp2)
+		cofactor = 2p - r = p - 1 + t where t = 6z^2 + 1
+		psi^2 - t psi + p = 0 on E'(Fp2) for the twisted Frobenius psi
+		so Q = t psi(P) - psi^2(P) + (t - 1)P = 6z^2(P + psi(P)) + psi(P) - psi^2(P)
+		the value is equal to G2::mulGeneric(Q, P, cofactor)
+		cf. L. Fuentes-Castaneda, E. Knapp, F. Rodriguez-Henriquez, Faster hashing to G2
+	*/
+	void mulByCofactor(G2& Q, const G2& P) const
+	{
+		typedef HaveFrobenius<G2> G2withF;
+		G2 T0, T1;
+		G2withF::Frobenius(T0, P);
+		G2withF::Frobenius(T1, T0);
+		G2::sub(T0, T0, T1); // psi(P) - psi^2(P)
+		G2withF::Frobenius(T1, P);
+		G2::add(T1, T1, P); // P + psi(P)
+		mulBy6z2(T1, T1);
+		G2::add(Q, T1, T0);
+	}
 	/*
 		get the element in G2 by multiplying the cofactor
 	*/
@@ -136,7 +199,7 @@ struct MapToT {
 		/*
 			G2::mul (GLV method) can't be used because P is not on G2
 		*/
-		G2::mulGeneric(P, P, cofactor);
+		mulByCofactor(P, P);
 		assert(!P.isZero());
 	}
 };
@@ -153,6 +216,21 @@ struct GLV1 {
 	mpz_class v0, v1;
 	mpz_class B[2][2];
 	mpz_class r;
+	static const size_t maxNafW = 8;
+private:
+	size_t nafW; // width of NAF used in mul if !constTime (2 <= nafW <= maxNafW)
+public:
+	GLV1() : m(0), nafW(5) {}
+	/*
+		set width of NAF used in mul if !constTime
+		2 <= w <= maxNafW
+	*/
+	void setNafW(size_t w)
+	{
+		if (w < 2 || w > maxNafW) throw cybozu::Exception("GLV1:setNafW:bad w") << w;
+		nafW = w;
+	}
+	size_t getNafW() const { return nafW; }
 	void init(const mpz_class& r, const mpz_class& z)
 	{
 		if (!Fp::squareRoot(rw, -3)) throw cybozu::Exception("GLV1:init");
@@ -189,6 +267,10 @@ struct GLV1 {
 		a = x - (t * B[0][0] + b * B[1][0]);
 		b = - (t * B[0][1] + b * B[1][1]);
 	}
+	void split(mpz_class u[2], const mpz_class& x) const
+	{
+		split(u[0], u[1], x);
+	}
 	void mul(G1& Q, const G1& P, mpz_class x, bool constTime = false) const
 	{
 		typedef mcl::fp::Unit Unit;
@@ -213,6 +295,10 @@ struct GLV1 {
 			x += r;
 		}
 		split(u[0], u[1], x);
+		if (!constTime) {
+			mulNAF(Q, P, u);
+			return;
+		}
 		in[0] = P;
 		mulLambda(in[1], in[0]);
 		for (int i = 0; i < splitN; i++) {
@@ -272,6 +358,84 @@ struct GLV1 {
 			D += tbl[0];
 		}
 	}
+	/*
+		Q = u[0] P + u[1] lambda(P)
+		by the joint width-nafW NAF with the normalized odd multiples of P and lambda(P)
+	*/
+	void mulNAF(G1& Q, const G1& P, const mpz_class u[2]) const
+	{
+		typedef mcl::fp::Unit Unit;
+		const size_t maxUnit = 512 / 2 / mcl::fp::UnitBitSize;
+		const int splitN = 2;
+		const size_t tblN = size_t(1) << (nafW - 2);
+		G1 tbl[splitN][size_t(1) << (maxNafW - 2)];
+		std::vector<int8_t> naf[splitN];
+		size_t maxBit = 0;
+		for (int i = 0; i < splitN; i++) {
+			Unit w[maxUnit];
+			mcl::gmp::getArray(w, maxUnit, gmp::abs(u[i]));
+			mcl::fp::getNAFwidth(naf[i], w, maxUnit, nafW);
+			if (u[i] < 0) {
+				for (size_t j = 0; j < naf[i].size(); j++) naf[i][j] = -naf[i][j];
+			}
+			maxBit = std::max(maxBit, naf[i].size());
+		}
+		// tbl[0][i] = (2i + 1)P, tbl[1][i] = lambda(tbl[0][i])
+		tbl[0][0] = P;
+		if (tblN > 1) {
+			G1 P2;
+			G1::dbl(P2, P);
+			for (size_t i = 1; i < tblN; i++) {
+				G1::add(tbl[0][i], tbl[0][i - 1], P2);
+			}
+		}
+		G1::normalizeVec(tbl[0], tbl[0], tblN);
+		for (size_t i = 0; i < tblN; i++) {
+			mulLambda(tbl[1][i], tbl[0][i]);
+		}
+		Q.clear();
+		for (size_t i = maxBit - 1; i != size_t(-1); i--) {
+			G1::dbl(Q, Q);
+			for (int j = 0; j < splitN; j++) {
+				if (i >= naf[j].size()) continue;
+				const int v = naf[j][i];
+				if (v > 0) {
+					G1::add(Q, Q, tbl[j][v >> 1]);
+				} else if (v < 0) {
+					G1::sub(Q, Q, tbl[j][(-v) >> 1]);
+				}
+			}
+		}
+	}
+	/*
+		Q = sum_{i=0}^{n-1} P[i] * y[i * yn, (i + 1) * yn)
+		split each scalar into a + b lambda and call Pippenger's method for 2n half-size scalars
+	*/
+	void mulVec(G1& Q, const G1 *P, const mcl::fp::Unit *y, size_t yn, size_t n) const
+	{
+		typedef mcl::fp::Unit Unit;
+		const size_t maxUnit = 512 / 2 / mcl::fp::UnitBitSize;
+		const int splitN = 2;
+		std::vector<G1> in(n * splitN);
+		std::vector<Unit> w(n * splitN * maxUnit);
+		mpz_class s, u[splitN];
+		G1::normalizeVec(&in[0], P, n);
+		for (size_t i = 0; i < n; i++) {
+			mcl::gmp::setArray(s, y + i * yn, yn);
+			s %= r;
+			split(u[0], u[1], s);
+			mulLambda(in[n + i], in[i]);
+			for (int j = 0; j < splitN; j++) {
+				const size_t idx = j * n + i;
+				if (u[j] < 0) {
+					u[j] = -u[j];
+					G1::neg(in[idx], in[idx]);
+				}
+				mcl::gmp::getArray(&w[idx * maxUnit], maxUnit, u[j]);
+			}
+		}
+		G1::mulVecArrayBase(Q, &in[0], &w[0], maxUnit, n * splitN);
+	}
 };
 
 /*
@@ -337,7 +501,21 @@ struct GLV2 {
 	mpz_class B[4][4];
 	mpz_class r;
 	mpz_class v[4];
-	GLV2() : m(0) {}
+	static const size_t maxNafW = 6;
+private:
+	size_t nafW; // width of NAF used in mul and pow if !constTime (2 <= nafW <= maxNafW)
+public:
+	GLV2() : m(0), nafW(4) {}
+	/*
+		set width of NAF used in mul and pow if !constTime
+		2 <= w <= maxNafW
+	*/
+	void setNafW(size_t w)
+	{
+		if (w < 2 || w > maxNafW) throw cybozu::Exception("GLV2:setNafW:bad w") << w;
+		nafW = w;
+	}
+	size_t getNafW() const { return nafW; }
 	void init(const mpz_class& r, const mpz_class& z)
 	{
 		this->r = r;
@@ -384,6 +562,18 @@ struct GLV2 {
 			}
 		}
 	}
+	/*
+		lambda = p mod r
+		lambda Q = Frobenius(Q) for Q in G2 or GT
+	*/
+	void mulLambda(G2& Q, const G2& P) const
+	{
+		HaveFrobenius<G2>::Frobenius(Q, P);
+	}
+	void mulLambda(Fp12& y, const Fp12& x) const
+	{
+		Fp12::Frobenius(y, x);
+	}
 	template<class T>
 	void mul(T& Q, const T& P, mpz_class x, bool constTime = false) const
 	{
@@ -416,6 +606,10 @@ struct GLV2 {
 			x += r;
 		}
 		split(u, x);
+		if (!constTime) {
+			mulNAF(Q, P, u);
+			return;
+		}
 		in[0] = P;
 		T::Frobenius(in[1], in[0]);
 		T::Frobenius(in[2], in[1]);
@@ -493,6 +687,61 @@ struct GLV2 {
 			D += tbl[0];
 		}
 	}
+	/*
+		Q = sum_i u[i] Frobenius^i(P)
+		by the joint width-nafW NAF with the normalized odd multiples of P and their Frobenius images
+	*/
+	template<class T>
+	void mulNAF(T& Q, const T& P, const mpz_class u[4]) const
+	{
+		typedef mcl::fp::Unit Unit;
+		const size_t maxUnit = 512 / 2 / mcl::fp::UnitBitSize;
+		const int splitN = 4;
+		const size_t tblN = size_t(1) << (nafW - 2);
+		std::vector<T> tbl[splitN];
+		std::vector<int8_t> naf[splitN];
+		size_t maxBit = 0;
+		for (int i = 0; i < splitN; i++) {
+			Unit w[maxUnit];
+			mcl::gmp::getArray(w, maxUnit, gmp::abs(u[i]));
+			mcl::fp::getNAFwidth(naf[i], w, maxUnit, nafW);
+			if (u[i] < 0) {
+				for (size_t j = 0; j < naf[i].size(); j++) naf[i][j] = -naf[i][j];
+			}
+			maxBit = std::max(maxBit, naf[i].size());
+		}
+		// tbl[0][i] = (2i + 1)P, tbl[j][i] = Frobenius(tbl[j - 1][i])
+		for (int j = 0; j < splitN; j++) tbl[j].resize(tblN);
+		tbl[0][0] = P;
+		if (tblN > 1) {
+			T P2;
+			T::dbl(P2, P);
+			for (size_t i = 1; i < tblN; i++) {
+				T::add(tbl[0][i], tbl[0][i - 1], P2);
+			}
+		}
+		T::normalizeVec(&tbl[0][0], &tbl[0][0], tblN);
+		for (int j = 1; j < splitN; j++) {
+			for (size_t i = 0; i < tblN; i++) {
+				T::Frobenius(tbl[j][i], tbl[j - 1][i]);
+			}
+		}
+		Q.clear();
+		for (size_t i = maxBit - 1; i != size_t(-1); i--) {
+			T::dbl(Q, Q);
+			for (int j = 0; j < splitN; j++) {
+				if (i >= naf[j].size()) continue;
+				const int v = naf[j][i];
+				if (v > 0) {
+					T::add(Q, Q, tbl[j][v >> 1]);
+				} else if (v < 0) {
+					T N;
+					T::neg(N, tbl[j][(-v) >> 1]);
+					T::add(Q, Q, N);
+				}
+			}
+		}
+	}
 	void mul(G2& Q, const G2& P, mpz_class x, bool constTime = false) const
 	{
 		typedef HaveFrobenius<G2> G2withF;
@@ -507,6 +756,218 @@ struct GLV2 {
 		const AG& _x = static_cast<const AG&>(x);
 		mul(_z, _x, y, constTime);
 	}
+	/*
+		Q = sum_{i=0}^{n-1} P[i] * y[i * yn, (i + 1) * yn)
+		split each scalar by Frobenius and call Pippenger's method for 4n quarter-size scalars
+	*/
+	void mulVec(G2& Q, const G2 *P, const mcl::fp::Unit *y, size_t yn, size_t n) const
+	{
+		typedef HaveFrobenius<G2> G2withF;
+		typedef mcl::fp::Unit Unit;
+		const size_t maxUnit = 512 / 2 / mcl::fp::UnitBitSize;
+		const int splitN = 4;
+		std::vector<G2> in(n * splitN);
+		std::vector<Unit> w(n * splitN * maxUnit);
+		mpz_class s, u[splitN];
+		G2::normalizeVec(&in[0], P, n);
+		for (size_t i = 0; i < n; i++) {
+			mcl::gmp::setArray(s, y + i * yn, yn);
+			s %= r;
+			split(u, s);
+			// Frobenius keeps z = 1
+			for (int j = 1; j < splitN; j++) {
+				G2withF::Frobenius(in[j * n + i], in[(j - 1) * n + i]);
+			}
+			for (int j = 0; j < splitN; j++) {
+				const size_t idx = j * n + i;
+				if (u[j] < 0) {
+					u[j] = -u[j];
+					G2::neg(in[idx], in[idx]);
+				}
+				mcl::gmp::getArray(&w[idx * maxUnit], maxUnit, u[j]);
+			}
+		}
+		G2::mulVecArrayBase(Q, &in[0], &w[0], maxUnit, n * splitN);
+	}
+};
+
+/*
+	fixed-base multiplication x -> xP by the GLV split and signed windows
+	G ; G1(GLV = GLV1, splitN = 2), G2 or GroupMtoA<Fp12>(GLV = GLV2, splitN = 4)
+	x = sum_j u[j] lambda^j mod r and |u[j]| < 2^bitSize
+	xP = sum_j lambda^j (sum_i d[j][i] 2^(winSize i) P) where |d[j][i]| <= H = 2^(winSize - 1)
+	tbl[i * H + d - 1] = d 2^(winSize i) P for 0 <= i < tblNum, 1 <= d <= H
+	the last row is cut at the maximum digit allowed by the bound of |u[j]|
+	the table is a cache-line-aligned array of about (bitSize / winSize) H elements
+	and about 1/(2 splitN) of WindowMethod with the same winSize
+*/
+template<class G, class GLV, int splitN>
+class FixedBaseGLV {
+	static const size_t cacheLineSize = 64;
+	typedef mcl::fp::Unit Unit;
+	const GLV *glv_;
+	size_t winSize_;
+	size_t tblNum_;
+	size_t tblSize_;
+	std::vector<char> buf_;
+	G *tbl_; // &buf_[0] aligned to cacheLineSize
+	void alloc(size_t n)
+	{
+		tblSize_ = n;
+		buf_.resize(n * sizeof(G) + cacheLineSize);
+		size_t pad = size_t(uintptr_t(&buf_[0]) % cacheLineSize);
+		if (pad) pad = cacheLineSize - pad;
+		tbl_ = reinterpret_cast<G*>(&buf_[pad]);
+		for (size_t i = 0; i < n; i++) {
+			new(&tbl_[i]) G();
+		}
+	}
+	void copy(const FixedBaseGLV& rhs)
+	{
+		glv_ = rhs.glv_;
+		winSize_ = rhs.winSize_;
+		tblNum_ = rhs.tblNum_;
+		alloc(rhs.tblSize_);
+		for (size_t i = 0; i < tblSize_; i++) {
+			tbl_[i] = rhs.tbl_[i];
+		}
+	}
+	/*
+		add (d 2^(winSize i))P to z
+		z is not initialized if isFirst
+	*/
+	void addTbl(G& z, bool& isFirst, size_t i, int d) const
+	{
+		if (d == 0) return;
+		const size_t H = size_t(1) << (winSize_ - 1);
+		const size_t pos = i * H + (d > 0 ? d : -d) - 1;
+		assert(pos < tblSize_);
+		const G& t = tbl_[pos];
+		if (isFirst) {
+			if (d > 0) {
+				z = t;
+			} else {
+				G::neg(z, t);
+			}
+			isFirst = false;
+			return;
+		}
+		if (d > 0) {
+			G::add(z, z, t);
+		} else {
+			G N;
+			G::neg(N, t);
+			G::add(z, z, N);
+		}
+	}
+	/*
+		z = u P for |u| < 2^(winSize tblNum - 1) by signed windows
+		return false if z = 0
+	*/
+	bool mulSmall(G& z, const mpz_class& u) const
+	{
+		const size_t maxUnit = 512 / 2 / mcl::fp::UnitBitSize;
+		Unit w[maxUnit];
+		mcl::gmp::getArray(w, maxUnit, gmp::abs(u));
+		const Unit mask = (Unit(1) << winSize_) - 1;
+		const int H = 1 << (winSize_ - 1);
+		const bool isNegative = u < 0;
+		bool isFirst = true;
+		int carry = 0;
+		for (size_t i = 0; i < tblNum_; i++) {
+			int d = int(mcl::fp::getUnitAt(w, maxUnit, i * winSize_) & mask) + carry;
+			carry = 0;
+			if (d > H) {
+				d -= 2 * H;
+				carry = 1;
+			}
+			addTbl(z, isFirst, i, isNegative ? -d : d);
+		}
+		if (carry) throw cybozu::Exception("FixedBaseGLV:mulSmall:too large") << u;
+		return !isFirst;
+	}
+public:
+	FixedBaseGLV() : glv_(0), winSize_(0), tblNum_(0), tblSize_(0), tbl_(0) {}
+	FixedBaseGLV(const FixedBaseGLV& rhs) { copy(rhs); }
+	FixedBaseGLV& operator=(const FixedBaseGLV& rhs)
+	{
+		if (this != &rhs) copy(rhs);
+		return *this;
+	}
+	/*
+		@param P [in] base point
+		@param glv [in] GLV1 or GLV2 initialized for the curve
+		@param winSize [in] window size (2 <= winSize <= 16)
+	*/
+	void init(const G& P, const GLV& glv, size_t winSize)
+	{
+		if (winSize < 2 || winSize > 16) throw cybozu::Exception("FixedBaseGLV:init:bad winSize") << winSize;
+		glv_ = &glv;
+		winSize_ = winSize;
+		// |u[i]| <= 2 sum_j |B[j][i]| by the rounding error of split
+		mpz_class maxB = 0;
+		for (int i = 0; i < splitN; i++) {
+			mpz_class t = 0;
+			for (int j = 0; j < splitN; j++) {
+				t += gmp::abs(glv.B[j][i]);
+			}
+			if (t > maxB) maxB = t;
+		}
+		const size_t bitSize = gmp::getBitSize(maxB * 2);
+		/*
+			|u[j]| < 2^bitSize
+			the digit of the last row is at most 2^(bitSize % winSize) <= H including the carry
+		*/
+		tblNum_ = bitSize / winSize + 1;
+		const size_t H = size_t(1) << (winSize - 1);
+		const size_t lastH = size_t(1) << (bitSize % winSize);
+		alloc((tblNum_ - 1) * H + lastH);
+		G t = P;
+		for (size_t i = 0; i < tblNum_; i++) {
+			G *w = &tbl_[i * H];
+			const size_t n = i < tblNum_ - 1 ? H : lastH;
+			w[0] = t;
+			for (size_t d = 1; d < n; d++) {
+				G::add(w[d], w[d - 1], t);
+			}
+			if (n == H) G::add(t, w[H - 1], w[H - 1]); // t = 2^(winSize (i + 1)) P
+			G::normalizeVec(w, w, n);
+		}
+	}
+	size_t getTblByteSize() const { return tblSize_ * sizeof(G); }
+	template<class tag, size_t maxBitSize>
+	void mul(G& z, const FpT<tag, maxBitSize>& y) const
+	{
+		mul(z, y.getMpz());
+	}
+	void mul(G& z, int64_t y) const
+	{
+		mpz_class t;
+		mcl::gmp::set(t, uint64_t(std::abs(y)));
+		if (y < 0) t = -t;
+		mul(z, t);
+	}
+	void mul(G& z, mpz_class x) const
+	{
+		x %= glv_->r;
+		if (x < 0) x += glv_->r;
+		mpz_class u[splitN];
+		glv_->split(u, x);
+		bool isZ = false; // z is not zero
+		for (int j = splitN - 1; j >= 0; j--) {
+			if (isZ) glv_->mulLambda(z, z);
+			G t;
+			if (mulSmall(t, u[j])) {
+				if (isZ) {
+					G::add(z, z, t);
+				} else {
+					z = t;
+					isZ = true;
+				}
+			}
+		}
+		if (!isZ) z.clear();
+	}
 };
 
 template<class Fp>
@@ -582,7 +1043,7 @@ struct ParamT {
 		G1::init(0, b, mcl::ec::Proj);
 		G2::init(0, twist_b, mcl::ec::Proj);
 		G2::setOrder(r);
-		mapTo.init(2 * p - r);
+		mapTo.init(2 * p - r, z);
 		glv1.init(r, z);
 
 		const mpz_class largest_c = gmp::abs(z * 6 + 2);
@@ -634,6 +1095,34 @@ struct BNT {
 		if (isNegative) s = -s;
 		param.glv2.mul(z, x, s, constTime);
 	}
+	static void mulVecGLV1(G1& z, const G1 *x, const mcl::fp::Unit *y, size_t yn, size_t n)
+	{
+		param.glv1.mulVec(z, x, y, yn, n);
+	}
+	static void mulVecGLV2(G2& z, const G2 *x, const mcl::fp::Unit *y, size_t yn, size_t n)
+	{
+		param.glv2.mulVec(z, x, y, yn, n);
+	}
+	/*
+		#E(Fp) = r for BN curves so a point on the curve is in G1
+	*/
+	static bool isValidOrderG1(const G1&)
+	{
+		return true;
+	}
+	/*
+		Q in E'(Fp2) is in G2 iff psi(Q) = 6z^2 Q
+		if psi(Q) = lambda Q for lambda = 6z^2 = t - 1
+		then (lambda^2 - t lambda + p)Q = (p + 1 - t)Q = rQ = 0
+		by psi^2 - t psi + p = 0
+	*/
+	static bool isValidOrderG2(const G2& Q)
+	{
+		G2 T0, T1;
+		G2withF::Frobenius(T0, Q);
+		param.mapTo.mulBy6z2(T1, Q);
+		return T0 == T1;
+	}
 	static void powArrayGLV2(Fp12& z, const Fp12& x, const mcl::fp::Unit *y, size_t yn, bool isNegative, bool constTime)
 	{
 		mpz_class s;
@@ -647,6 +1136,10 @@ struct BNT {
 		G1::setMulArrayGLV(mulArrayGLV1);
 		param.glv2.init(param.r, param.z);
 		G2::setMulArrayGLV(mulArrayGLV2);
+		G1::setMulVecGLV(mulVecGLV1);
+		G2::setMulVecGLV(mulVecGLV2);
+		G1::setIsValidOrderFast(isValidOrderG1);
+		G2::setIsValidOrderFast(isValidOrderG2);
 		Fp12::setPowArrayGLV(powArrayGLV2);
 		const bool isMtype = false;
 		G2withF::init(isMtype);
@@ -992,80 +1485,11 @@ struct BNT {
 		mpz_class p2 = p * p;
 		mpz_class p4 = p2 * p2;
 		Fp12::pow(y, x, (p4 - p2 + 1) / param.r);
-#endif
-	}
-	/*
-		Faster Squaring in the Cyclotomic Subgroup of Sixth Degree Extensions
-		Robert Granger, Michael Scott
-	*/
-	static void sqrFp4(Fp2& z0, Fp2& z1, const Fp2& x0, const Fp2& x1)
-	{
-#if 1
-		Fp2Dbl T0, T1, T2;
-		Fp2Dbl::sqrPre(T0, x0);
-		Fp2Dbl::sqrPre(T1, x1);
-		Fp2Dbl::mul_xi(T2, T1);
-		Fp2Dbl::add(T2, T2, T0);
-		Fp2::add(z1, x0, x1);
-		Fp2Dbl::mod(z0, T2);
-		Fp2Dbl::sqrPre(T2, z1);
-		Fp2Dbl::sub(T2, T2, T0);
-		Fp2Dbl::sub(T2, T2, T1);
-		Fp2Dbl::mod(z1, T2);
-#else
-		Fp2 t0, t1, t2;
-		Fp2::sqr(t0, x0);
-		Fp2::sqr(t1, x1);
-		Fp2::mul_xi(z0, t1);
-		z0 += t0;
-		Fp2::add(z1, x0, x1);
-		Fp2::sqr(z1, z1);
-		z1 -= t0;
-		z1 -= t1;
 #endif
 	}
 	static void fasterSqr(Fp12& y, const Fp12& x)
 	{
-#if 0
-		Fp12::sqr(y, x);
-#else
-		const Fp2& x0(x.a.a);
-		const Fp2& x4(x.a.b);
-		const Fp2& x3(x.a.c);
-		const Fp2& x2(x.b.a);
-		const Fp2& x1(x.b.b);
-		const Fp2& x5(x.b.c);
-		Fp2& y0(y.a.a);
-		Fp2& y4(y.a.b);
-		Fp2& y3(y.a.c);
-		Fp2& y2(y.b.a);
-		Fp2& y1(y.b.b);
-		Fp2& y5(y.b.c);
-		Fp2 t0, t1;
-		sqrFp4(t0, t1, x0, x1);
-		Fp2::sub(y0, t0, x0);
-		y0 += y0;
-		y0 += t0;
-		Fp2::add(y1, t1, x1);
-		y1 += y1;
-		y1 += t1;
-		Fp2 t2, t3;
-		sqrFp4(t0, t1, x2, x3);
-		sqrFp4(t2, t3, x4, x5);
-		Fp2::sub(y4, t0, x4);
-		y4 += y4;
-		y4 += t0;
-		Fp2::add(y5, t1, x5);
-		y5 += y5;
-		y5 += t1;
-		Fp2::mul_xi(t0, t3);
-		Fp2::add(y2, t0, x2);
-		y2 += y2;
-		y2 += t0;
-		Fp2::sub(y3, t2, x3);
-		y3 += y3;
-		y3 += t2;
-#endif
+		Fp12::sqrCyclotomic(y, x);
 	}
 	struct Compress {
 		Fp12& z_;
@@ -1539,6 +1963,220 @@ struct BNT {
 		f *= f1;
 		f *= f2;
 	}
+	/*
+		f = prod_{i=0}^{n-1} millerLoop(P[i], Q[i])
+		the squaring of f in each step is shared by all the pairs
+	*/
+	static void millerLoopVec(Fp12& f, const G1 *P_, const G2 *Q_, size_t n)
+	{
+		std::vector<G1> P(n);
+		std::vector<G2> Q(n);
+		if (n > 0) {
+			G1::normalizeVec(&P[0], P_, n);
+			G2::normalizeVec(&Q[0], Q_, n);
+		}
+		// remove the pairs such that millerLoop(P, 0) = 1
+		size_t m = 0;
+		for (size_t i = 0; i < n; i++) {
+			if (Q[i].isZero()) continue;
+			P[m] = P[i];
+			Q[m] = Q[i];
+			m++;
+		}
+		if (m == 0) {
+			f = 1;
+			return;
+		}
+		n = m;
+		std::vector<G2> T(Q.begin(), Q.begin() + n);
+		std::vector<G2> negQ;
+		if (param.useNAF) {
+			negQ.resize(n);
+			for (size_t i = 0; i < n; i++) {
+				G2::neg(negQ[i], Q[i]);
+			}
+		}
+		Fp6 d, e;
+		Fp12 ft;
+		assert(param.siTbl[1] == 1);
+		for (size_t i = 0; i < n; i++) {
+			dblLine(d, T[i], P[i]);
+			addLine(e, T[i], Q[i], P[i]);
+			if (i == 0) {
+				mul_024_024(f, d, e);
+			} else {
+				mul_024_024(ft, d, e);
+				f *= ft;
+			}
+		}
+		Fp6 l;
+		for (size_t j = 2; j < param.siTbl.size(); j++) {
+			Fp12::sqr(f, f);
+			for (size_t i = 0; i < n; i++) {
+				dblLine(l, T[i], P[i]);
+				mul_024(f, l);
+				if (param.siTbl[j]) {
+					if (param.siTbl[j] > 0) {
+						addLine(l, T[i], Q[i], P[i]);
+					} else {
+						addLine(l, T[i], negQ[i], P[i]);
+					}
+					mul_024(f, l);
+				}
+			}
+		}
+		if (param.z < 0) {
+			Fp6::neg(f.b, f.b);
+		}
+		for (size_t i = 0; i < n; i++) {
+			G2 Q1, Q2;
+			G2withF::Frobenius(Q1, Q[i]);
+			G2withF::Frobenius(Q2, Q1);
+			G2::neg(Q2, Q2);
+			if (param.z < 0) {
+				G2::neg(T[i], T[i]);
+			}
+			addLine(d, T[i], Q1, P[i]);
+			addLine(e, T[i], Q2, P[i]);
+			mul_024_024(ft, d, e);
+			f *= ft;
+		}
+	}
+	/*
+		f = prod_{i=0}^{n-1} precomputedMillerLoop(P[i], Qcoeff + i * param.precomputedQcoeffSize)
+		Qcoeff is the concatenation of n outputs of precomputeG2
+	*/
+	static void precomputedMillerLoopVec(Fp12& f, const G1 *P_, const std::vector<Fp6>& Qcoeff, size_t n)
+	{
+		assert(Qcoeff.size() >= n * param.precomputedQcoeffSize);
+		precomputedMillerLoopVec(f, P_, Qcoeff.data(), n);
+	}
+	static void precomputedMillerLoopVec(Fp12& f, const G1 *P_, const Fp6 *Qcoeff, size_t n)
+	{
+		if (n == 0) {
+			f = 1;
+			return;
+		}
+		std::vector<G1> P(n);
+		G1::normalizeVec(&P[0], P_, n);
+		const size_t QcoeffSize = param.precomputedQcoeffSize;
+		size_t idx = 0;
+		Fp6 d, e;
+		Fp12 ft;
+		for (size_t i = 0; i < n; i++) {
+			const Fp6 *Qi = Qcoeff + i * QcoeffSize;
+			mulFp6cb_by_G1xy(d, Qi[idx], P[i]);
+			mulFp6cb_by_G1xy(e, Qi[idx + 1], P[i]);
+			if (i == 0) {
+				mul_024_024(f, d, e);
+			} else {
+				mul_024_024(ft, d, e);
+				f *= ft;
+			}
+		}
+		idx += 2;
+		Fp6 l;
+		for (size_t j = 2; j < param.siTbl.size(); j++) {
+			Fp12::sqr(f, f);
+			for (size_t i = 0; i < n; i++) {
+				const Fp6 *Qi = Qcoeff + i * QcoeffSize;
+				mulFp6cb_by_G1xy(l, Qi[idx], P[i]);
+				mul_024(f, l);
+				if (param.siTbl[j]) {
+					mulFp6cb_by_G1xy(l, Qi[idx + 1], P[i]);
+					mul_024(f, l);
+				}
+			}
+			idx += param.siTbl[j] ? 2 : 1;
+		}
+		if (param.z < 0) {
+			Fp6::neg(f.b, f.b);
+		}
+		for (size_t i = 0; i < n; i++) {
+			const Fp6 *Qi = Qcoeff + i * QcoeffSize;
+			mulFp6cb_by_G1xy(d, Qi[idx], P[i]);
+			mulFp6cb_by_G1xy(e, Qi[idx + 1], P[i]);
+			mul_024_024(ft, d, e);
+			f *= ft;
+		}
+		assert(idx + 2 == QcoeffSize);
+	}
+	/*
+		f = prod_{i=0}^{n-1} pairing(P[i], Q[i]) by one finalExp
+	*/
+	static void pairingVec(Fp12& f, const G1 *P, const G2 *Q, size_t n)
+	{
+		millerLoopVec(f, P, Q, n);
+		finalExp(f, f);
+	}
+	/*
+		multi-threaded millerLoopVec with OpenMP (MCL_USE_OMP=1)
+		split the pairs into cpuN ranges and multiply the partial products of them
+		use omp_get_max_threads() if cpuN = 0
+		same as millerLoopVec if MCL_USE_OMP is not defined
+	*/
+	static void millerLoopVecMT(Fp12& f, const G1 *P, const G2 *Q, size_t n, size_t cpuN = 0)
+	{
+#ifdef MCL_USE_OMP
+		const size_t minN = 4; // the least number of pairs per thread
+		if (cpuN == 0) cpuN = omp_get_max_threads();
+		if (cpuN > n / minN) cpuN = n / minN;
+		if (cpuN > 1) {
+			std::vector<Fp12> partial(cpuN);
+			#pragma omp parallel for num_threads(int(cpuN))
+			for (int i = 0; i < int(cpuN); i++) {
+				const size_t begin = n * i / cpuN;
+				const size_t end = n * (i + 1) / cpuN;
+				millerLoopVec(partial[i], P + begin, Q + begin, end - begin);
+			}
+			for (size_t i = 1; i < cpuN; i++) {
+				partial[0] *= partial[i];
+			}
+			f = partial[0];
+			return;
+		}
+#else
+		(void)cpuN;
+#endif
+		millerLoopVec(f, P, Q, n);
+	}
+	/*
+		multi-threaded precomputedMillerLoopVec
+	*/
+	static void precomputedMillerLoopVecMT(Fp12& f, const G1 *P, const Fp6 *Qcoeff, size_t n, size_t cpuN = 0)
+	{
+#ifdef MCL_USE_OMP
+		const size_t minN = 4; // the least number of pairs per thread
+		if (cpuN == 0) cpuN = omp_get_max_threads();
+		if (cpuN > n / minN) cpuN = n / minN;
+		if (cpuN > 1) {
+			const size_t QcoeffSize = param.precomputedQcoeffSize;
+			std::vector<Fp12> partial(cpuN);
+			#pragma omp parallel for num_threads(int(cpuN))
+			for (int i = 0; i < int(cpuN); i++) {
+				const size_t begin = n * i / cpuN;
+				const size_t end = n * (i + 1) / cpuN;
+				precomputedMillerLoopVec(partial[i], P + begin, Qcoeff + begin * QcoeffSize, end - begin);
+			}
+			for (size_t i = 1; i < cpuN; i++) {
+				partial[0] *= partial[i];
+			}
+			f = partial[0];
+			return;
+		}
+#else
+		(void)cpuN;
+#endif
+		precomputedMillerLoopVec(f, P, Qcoeff, n);
+	}
+	/*
+		f = prod_{i=0}^{n-1} pairing(P[i], Q[i]) by cpuN threads and one finalExp
+	*/
+	static void pairingVecMT(Fp12& f, const G1 *P, const G2 *Q, size_t n, size_t cpuN = 0)
+	{
+		millerLoopVecMT(f, P, Q, n, cpuN);
+		finalExp(f, f);
+	}
 	static void mapToG1(G1& P, const Fp& x) { param.mapTo.calcG1(P, x); }
 	static void mapToG2(G2& P, const Fp2& x) { param.mapTo.calcG2(P, x); }
 	static void hashAndMapToG1(G1& P, const void *buf, size_t bufSize)
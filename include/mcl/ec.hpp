@@ -8,9 +8,13 @@
 */
 #include <sstream>
 #include <stdlib.h>
+#include <vector>
 #include <cybozu/exception.hpp>
 #include <mcl/op.hpp>
 #include <mcl/util.hpp>
+#ifdef MCL_USE_OMP
+#include <omp.h>
+#endif
 
 //#define MCL_EC_USE_AFFINE
 
@@ -63,6 +67,8 @@ public:
 	static bool verifyOrder_;
 	static mpz_class order_;
 	static void (*mulArrayGLV)(EcT& z, const EcT& x, const fp::Unit *y, size_t yn, bool isNegative, bool constTime);
+	static void (*mulVecGLV)(EcT& z, const EcT *x, const fp::Unit *y, size_t yn, size_t n);
+	static bool (*isValidOrderFast)(const EcT& x);
 	/* default constructor is undefined value */
 	EcT() {}
 	EcT(const Fp& _x, const Fp& _y)
@@ -161,6 +167,52 @@ public:
 		y = x;
 		y.normalize();
 	}
+	/*
+		y[i] = normalized x[i] for i in [0, n) by one inversion
+		y may be equal to x
+	*/
+	static inline void normalizeVec(EcT *y, const EcT *x, size_t n)
+	{
+		if (n == 0) return;
+#ifdef MCL_EC_USE_AFFINE
+		if (y != x) {
+			for (size_t i = 0; i < n; i++) y[i] = x[i];
+		}
+#else
+		std::vector<Fp> rz(n);
+		for (size_t i = 0; i < n; i++) {
+			// skip normalized points (inv ignores zero)
+			if (x[i].isNormalized()) {
+				rz[i].clear();
+			} else {
+				rz[i] = x[i].z;
+			}
+		}
+		Fp::invVec(&rz[0], &rz[0], n);
+		for (size_t i = 0; i < n; i++) {
+			if (rz[i].isZero()) {
+				y[i] = x[i];
+				continue;
+			}
+			switch (mode_) {
+			case ec::Jacobi:
+				{
+					Fp rz2;
+					Fp::sqr(rz2, rz[i]);
+					Fp::mul(y[i].x, x[i].x, rz2);
+					rz2 *= rz[i];
+					Fp::mul(y[i].y, x[i].y, rz2);
+				}
+				break;
+			case ec::Proj:
+				Fp::mul(y[i].x, x[i].x, rz[i]);
+				Fp::mul(y[i].y, x[i].y, rz[i]);
+				break;
+			}
+			y[i].z = 1;
+		}
+#endif
+	}
 	static inline void init(const Fp& a, const Fp& b, int mode = ec::Jacobi)
 	{
 		a_ = a;
@@ -200,6 +252,17 @@ public:
 	{
 		mulArrayGLV = f;
 	}
+	static void setMulVecGLV(void f(EcT& z, const EcT *x, const fp::Unit *y, size_t yn, size_t n))
+	{
+		mulVecGLV = f;
+	}
+	/*
+		f(x) returns true iff x on the curve is in the subgroup of order_
+	*/
+	static void setIsValidOrderFast(bool f(const EcT& x))
+	{
+		isValidOrderFast = f;
+	}
 	// backward compatilibity
 	static inline void setParam(const std::string& astr, const std::string& bstr, int mode = ec::Jacobi)
 	{
@@ -212,6 +275,7 @@ public:
 	// verify the order
 	bool isValidOrder() const
 	{
+		if (isValidOrderFast) return isValidOrderFast(*this);
 		EcT Q;
 		EcT::mulGeneric(Q, *this, order_);
 		return Q.isZero();
@@ -838,6 +902,141 @@ public:
 			neg(z, z);
 		}
 	}
+	/*
+		z = sum_{i=0}^{n-1} x[i] * y[i]
+	*/
+	template<class tag, size_t maxBitSize, template<class _tag, size_t _maxBitSize>class FpT>
+	static inline void mulVec(EcT& z, const EcT *x, const FpT<tag, maxBitSize> *y, size_t n)
+	{
+		if (n == 0) {
+			z.clear();
+			return;
+		}
+		fp::Block b;
+		y[0].getBlock(b);
+		const size_t yn = b.n;
+		std::vector<fp::Unit> yVec(n * yn);
+		for (size_t i = 0; i < n; i++) {
+			y[i].getBlock(b);
+			fp::copyArray(&yVec[i * yn], b.p, yn);
+		}
+		mulVecArray(z, x, &yVec[0], yn, n);
+	}
+	/*
+		multi-threaded mulVec with OpenMP (MCL_USE_OMP=1)
+		split x[0, n) into cpuN ranges and add the partial sums of them
+		use omp_get_max_threads() if cpuN = 0
+		same as mulVec if MCL_USE_OMP is not defined
+	*/
+	template<class tag, size_t maxBitSize, template<class _tag, size_t _maxBitSize>class FpT>
+	static inline void mulVecMT(EcT& z, const EcT *x, const FpT<tag, maxBitSize> *y, size_t n, size_t cpuN = 0)
+	{
+#ifdef MCL_USE_OMP
+		const size_t minN = 64; // the least number of points per thread
+		if (cpuN == 0) cpuN = omp_get_max_threads();
+		if (cpuN > n / minN) cpuN = n / minN;
+		if (cpuN > 1) {
+			std::vector<EcT> partial(cpuN);
+			#pragma omp parallel for num_threads(int(cpuN))
+			for (int i = 0; i < int(cpuN); i++) {
+				const size_t begin = n * i / cpuN;
+				const size_t end = n * (i + 1) / cpuN;
+				mulVec(partial[i], x + begin, y + begin, end - begin);
+			}
+			for (size_t i = 1; i < cpuN; i++) {
+				add(partial[0], partial[0], partial[i]);
+			}
+			z = partial[0];
+			return;
+		}
+#else
+		(void)cpuN;
+#endif
+		mulVec(z, x, y, n);
+	}
+	/*
+		z = sum_{i=0}^{n-1} x[i] * y[i * yn, (i + 1) * yn)
+	*/
+	static inline void mulVecArray(EcT& z, const EcT *x, const fp::Unit *y, size_t yn, size_t n)
+	{
+		if (mulVecGLV && n > 0) {
+			mulVecGLV(z, x, y, yn, n);
+			return;
+		}
+		mulVecArrayBase(z, x, y, yn, n);
+	}
+	/*
+		the window size c minimizing the number of additions
+		(bitSize / c) * (n + 2^(c+1)) of Pippenger's method
+	*/
+	static inline size_t getMulVecWindowSize(size_t n, size_t bitSize)
+	{
+		const size_t maxC = 16;
+		size_t c = 1;
+		uint64_t minCost = uint64_t(-1);
+		for (size_t i = 1; i <= maxC; i++) {
+			uint64_t cost = ((bitSize + i - 1) / i) * (uint64_t(n) + (uint64_t(1) << (i + 1)));
+			if (cost < minCost) {
+				minCost = cost;
+				c = i;
+			}
+		}
+		return c;
+	}
+	/*
+		Pippenger's bucket method
+		x[i] are normalized in advance so that each bucket addition is a mixed one
+	*/
+	static inline void mulVecArrayBase(EcT& z, const EcT *x, const fp::Unit *y, size_t yn, size_t n)
+	{
+		std::vector<EcT> xVec;
+		for (size_t i = 0; i < n; i++) {
+			if (!x[i].isNormalized()) {
+				xVec.resize(n);
+				normalizeVec(&xVec[0], x, n);
+				x = &xVec[0];
+				break;
+			}
+		}
+		size_t bitSize = 0;
+		for (size_t i = 0; i < n; i++) {
+			const fp::Unit *yi = y + i * yn;
+			const size_t m = fp::getNonZeroArraySize(yi, yn);
+			if (yi[m - 1] == 0) continue;
+			bitSize = std::max(bitSize, (m - 1) * fp::UnitBitSize + cybozu::bsr<fp::Unit>(yi[m - 1]) + 1);
+		}
+		if (bitSize == 0) {
+			z.clear();
+			return;
+		}
+		const size_t c = getMulVecWindowSize(n, bitSize);
+		const size_t tblN = (size_t(1) << c) - 1;
+		const fp::Unit mask = (fp::Unit(1) << c) - 1;
+		std::vector<EcT> tbl(tblN);
+		EcT s, win, sum;
+		s.clear();
+		for (size_t w = (bitSize + c - 1) / c; w-- > 0;) {
+			for (size_t j = 0; j < c; j++) {
+				dbl(s, s);
+			}
+			for (size_t j = 0; j < tblN; j++) {
+				tbl[j].clear();
+			}
+			for (size_t i = 0; i < n; i++) {
+				fp::Unit v = fp::getUnitAt(y + i * yn, yn, w * c) & mask;
+				if (v) add(tbl[v - 1], tbl[v - 1], x[i]);
+			}
+			// win = sum_j (j + 1) tbl[j]
+			win.clear();
+			sum.clear();
+			for (size_t j = tblN; j-- > 0;) {
+				add(sum, sum, tbl[j]);
+				add(win, win, sum);
+			}
+			add(s, s, win);
+		}
+		z = s;
+	}
 	/*
 		generic mul
 	*/
@@ -854,6 +1053,8 @@ template<class Fp> int EcT<Fp>::ioMode_;
 template<class Fp> bool EcT<Fp>::verifyOrder_;
 template<class Fp> mpz_class EcT<Fp>::order_;
 template<class Fp> void (*EcT<Fp>::mulArrayGLV)(EcT& z, const EcT& x, const fp::Unit *y, size_t yn, bool isNegative, bool constTime);
+template<class Fp> void (*EcT<Fp>::mulVecGLV)(EcT& z, const EcT *x, const fp::Unit *y, size_t yn, size_t n);
+template<class Fp> bool (*EcT<Fp>::isValidOrderFast)(const EcT& x);
 #ifndef MCL_EC_USE_AFFINE
 template<class Fp> int EcT<Fp>::mode_;
 #endif
@@ -123,14 +123,14 @@ public:
 		}
 		printf("\n");
 	}
-	static inline void init(const mpz_class& m, fp::Mode mode = fp::FP_AUTO)
+	static inline void init(const mpz_class& m, fp::Mode mode = fp::FP_AUTO, fp::InvMode invMode = fp::INV_AUTO)
 	{
-		init(gmp::getStr(m), mode);
+		init(gmp::getStr(m), mode, invMode);
 	}
-	static inline void init(const std::string& mstr, fp::Mode mode = fp::FP_AUTO)
+	static inline void init(const std::string& mstr, fp::Mode mode = fp::FP_AUTO, fp::InvMode invMode = fp::INV_AUTO)
 	{
 		assert(maxBitSize <= MCL_MAX_BIT_SIZE);
-		op_.init(mstr, maxBitSize, mode);
+		op_.init(mstr, maxBitSize, mode, invMode);
 		{ // set oneRep
 			FpT& one = *reinterpret_cast<FpT*>(op_.oneRep);
 			one.clear();
@@ -170,13 +170,14 @@ public:
 	}
 	static inline bool squareRoot(FpT& y, const FpT& x)
 	{
-		if (isMont()) return op_.sq.get(y, x);
-		mpz_class mx, my;
-		x.getMpz(mx);
-		bool b = op_.sq.get(my, mx);
-		if (!b) return false;
-		y.setMpz(my);
-		return true;
+		return op_.sq.get(y, x);
+	}
+	/*
+		return the Legendre symbol (x/p) = 0, 1 or -1
+	*/
+	static inline int legendre(const FpT& x)
+	{
+		return op_.fp_legendre(x.v_, op_);
 	}
 	FpT() {}
 	FpT(const FpT& x)
@@ -358,6 +359,10 @@ public:
 		op_.fp_mulUnit(z.v_, x.v_, y, op_.p);
 	}
 	static inline void inv(FpT& y, const FpT& x) { op_.fp_invOp(y.v_, x.v_, op_); }
+	/*
+		y[i] = 1 / x[i] by one inv (0 for x[i] = 0)
+	*/
+	static inline void invVec(FpT *y, const FpT *x, size_t n) { fp::invVec(y, x, n); }
 	static inline void neg(FpT& y, const FpT& x) { op_.fp_neg(y.v_, x.v_, op_.p); }
 	static inline void sqr(FpT& y, const FpT& x) { op_.fp_sqr(y.v_, x.v_, op_.p); }
 	static inline void divBy2(FpT& y, const FpT& x)
@@ -472,6 +477,14 @@ public:
 	{
 		op_.hash = hash;
 	}
+	/*
+		select the algorithm of inv
+		call it after init()
+	*/
+	static inline void setInvMode(fp::InvMode invMode)
+	{
+		op_.setInvMode(invMode);
+	}
 };
 
 template<class tag, size_t maxBitSize> fp::Op FpT<tag, maxBitSize>::op_;
@@ -157,6 +157,7 @@ public:
 	static void addPre(Fp2T& z, const Fp2T& x, const Fp2T& y) { Fp::addPre(z.a, x.a, y.a); Fp::addPre(z.b, x.b, y.b); }
 	static void mul(Fp2T& z, const Fp2T& x, const Fp2T& y) { Fp::op_.fp2_mul(z.a.v_, x.a.v_, y.a.v_); }
 	static void inv(Fp2T& y, const Fp2T& x) { Fp::op_.fp2_inv(y.a.v_, x.a.v_); }
+	static void invVec(Fp2T *y, const Fp2T *x, size_t n) { fp::invVec(y, x, n); }
 	static void neg(Fp2T& y, const Fp2T& x) { Fp::op_.fp2_neg(y.a.v_, x.a.v_); }
 	static void sqr(Fp2T& y, const Fp2T& x) { Fp::op_.fp2_sqr(y.a.v_, x.a.v_); }
 	static void mul_xi(Fp2T& y, const Fp2T& x) { Fp::op_.fp2_mul_xi(y.a.v_, x.a.v_); }
@@ -245,6 +246,33 @@ public:
 		Fp::sqr(t2, x.b);
 		t1 += t2; // c^2 + d^2
 		if (!Fp::squareRoot(t1, t1)) return false;
+		if (Fp::getOp().pmod4 == 3) {
+			/*
+				-1 is not a quadratic residue
+				A = (c + t1) / 2, B = (c - t1) / 2, AB = -d^2/4
+				so exactly one of A and -A is a quadratic residue
+				w = A^((p + 1) / 4), w^2 = A or -A
+				w^2 = A  : y = w + (d / 2w) i
+				w^2 = -A : y = d / 2w + w i
+			*/
+			Fp::add(t2, x.a, t1);
+			Fp::divBy2(t2, t2);
+			Fp::getOp().sq.powQuarter(t1, t2);
+			Fp w2;
+			Fp::sqr(w2, t1);
+			const bool isA = w2 == t2;
+			Fp::add(t2, t1, t1);
+			Fp::inv(t2, t2);
+			t2 *= x.b;
+			if (isA) {
+				y.a = t1;
+				y.b = t2;
+			} else {
+				y.a = t2;
+				y.b = t1;
+			}
+			return true;
+		}
 		Fp::add(t2, x.a, t1);
 		Fp::divBy2(t2, t2);
 		if (!Fp::squareRoot(t2, t2)) {
@@ -292,12 +320,17 @@ public:
 //		assert(Fp::maxSize <= 256);
 		xi_a_ = xi_a;
 		mcl::fp::Op& op = Fp::op_;
+		/*
+			fused kernels with lazy reduction are available
+			if Fp2T is two contiguous arrays of op.N Units
+		*/
+		const bool useNF = op.isMont && !op.isFullBit && sizeof(Fp) * 8 == op.N * fp::UnitBitSize;
 		op.fp2_add = fp2_addW;
 		op.fp2_sub = fp2_subW;
 		if (op.isFastMod) {
 			op.fp2_mul = fp2_mulW;
 		} else if (!op.isFullBit) {
-			if (0 && sizeof(Fp) * 8 == op.N * fp::UnitBitSize && op.fp2_mulNF) {
+			if (useNF && op.fp2_mulNF) {
 				op.fp2_mul = fp2_mulNFW;
 			} else {
 				op.fp2_mul = fp2_mulUseDblUseNCW;
@@ -307,7 +340,11 @@ public:
 		}
 		op.fp2_neg = fp2_negW;
 		op.fp2_inv = fp2_invW;
-		op.fp2_sqr = fp2_sqrW;
+		if (useNF && op.fp2_sqrNF) {
+			op.fp2_sqr = fp2_sqrNFW;
+		} else {
+			op.fp2_sqr = fp2_sqrW;
+		}
 		if (xi_a == 1) {
 			op.fp2_mul_xi = fp2_mul_xi_1_1i;
 		} else {
@@ -447,6 +484,11 @@ private:
 		FpDbl::sub(d1, d1, d2); // ac - bd
 		FpDbl::mod(pz[0], d1); // set z0
 	}
+	static void fp2_sqrNFW(Unit *y, const Unit *x)
+	{
+		const fp::Op& op = Fp::op_;
+		op.fp2_sqrNF(y, x, op.p);
+	}
 	/*
 		x = a + bi, i^2 = -1
 		y = x^2 = (a + bi)^2 = (a + b)(a - b) + 2abi
@@ -891,6 +933,7 @@ struct Fp12T : public fp::Serializable<Fp12T<Fp>,
 	fp::Operator<Fp12T<Fp> > > {
 	typedef Fp2T<Fp> Fp2;
 	typedef Fp6T<Fp> Fp6;
+	typedef Fp2DblT<Fp> Fp2Dbl;
 	typedef Fp BaseFp;
 	Fp6 a, b;
 	Fp12T() {}
@@ -1018,6 +1061,84 @@ struct Fp12T : public fp::Serializable<Fp12T<Fp>,
 		Fp6::mul(y.b, x.b, t0);
 		Fp6::neg(y.b, y.b);
 	}
+	static void invVec(Fp12T *y, const Fp12T *x, size_t n) { fp::invVec(y, x, n); }
+	/*
+		Faster Squaring in the Cyclotomic Subgroup of Sixth Degree Extensions
+		Robert Granger, Michael Scott
+	*/
+	static void sqrFp4(Fp2& z0, Fp2& z1, const Fp2& x0, const Fp2& x1)
+	{
+#if 1
+		Fp2Dbl T0, T1, T2;
+		Fp2Dbl::sqrPre(T0, x0);
+		Fp2Dbl::sqrPre(T1, x1);
+		Fp2Dbl::mul_xi(T2, T1);
+		Fp2Dbl::add(T2, T2, T0);
+		Fp2::add(z1, x0, x1);
+		Fp2Dbl::mod(z0, T2);
+		Fp2Dbl::sqrPre(T2, z1);
+		Fp2Dbl::sub(T2, T2, T0);
+		Fp2Dbl::sub(T2, T2, T1);
+		Fp2Dbl::mod(z1, T2);
+#else
+		Fp2 t0, t1, t2;
+		Fp2::sqr(t0, x0);
+		Fp2::sqr(t1, x1);
+		Fp2::mul_xi(z0, t1);
+		z0 += t0;
+		Fp2::add(z1, x0, x1);
+		Fp2::sqr(z1, z1);
+		z1 -= t0;
+		z1 -= t1;
+#endif
+	}
+	/*
+		y = x^2 for x in the cyclotomic subgroup (x^(p^6 + 1) = 1)
+		e.g. the outputs of the final exponentiation
+	*/
+	static void sqrCyclotomic(Fp12T& y, const Fp12T& x)
+	{
+#if 0
+		sqr(y, x);
+#else
+		const Fp2& x0(x.a.a);
+		const Fp2& x4(x.a.b);
+		const Fp2& x3(x.a.c);
+		const Fp2& x2(x.b.a);
+		const Fp2& x1(x.b.b);
+		const Fp2& x5(x.b.c);
+		Fp2& y0(y.a.a);
+		Fp2& y4(y.a.b);
+		Fp2& y3(y.a.c);
+		Fp2& y2(y.b.a);
+		Fp2& y1(y.b.b);
+		Fp2& y5(y.b.c);
+		Fp2 t0, t1;
+		sqrFp4(t0, t1, x0, x1);
+		Fp2::sub(y0, t0, x0);
+		y0 += y0;
+		y0 += t0;
+		Fp2::add(y1, t1, x1);
+		y1 += y1;
+		y1 += t1;
+		Fp2 t2, t3;
+		sqrFp4(t0, t1, x2, x3);
+		sqrFp4(t2, t3, x4, x5);
+		Fp2::sub(y4, t0, x4);
+		y4 += y4;
+		y4 += t0;
+		Fp2::add(y5, t1, x5);
+		y5 += y5;
+		y5 += t1;
+		Fp2::mul_xi(t0, t3);
+		Fp2::add(y2, t0, x2);
+		y2 += y2;
+		y2 += t0;
+		Fp2::sub(y3, t2, x3);
+		y3 += y3;
+		y3 += t2;
+#endif
+	}
 	/*
 		y = 1 / x = conjugate of x if |x| = 1
 	*/
@@ -1026,6 +1147,35 @@ struct Fp12T : public fp::Serializable<Fp12T<Fp>,
 		if (&y != &x) y.a = x.a;
 		Fp6::neg(y.b, x.b);
 	}
+	/*
+		z = x^y for x in the cyclotomic subgroup by sqrCyclotomic
+		x need not be of order r (use pow for GLV if x^r = 1)
+	*/
+	static void powCyclotomicArray(Fp12T& z, const Fp12T& x, const fp::Unit *y, size_t yn, bool isNegative)
+	{
+		Fp12T tmp;
+		const Fp12T *px = &x;
+		if (&z == &x) {
+			tmp = x;
+			px = &tmp;
+		}
+		z = 1;
+		fp::powGeneric(z, *px, y, yn, mul, sqrCyclotomic, (void (*)(Fp12T&, const Fp12T&))0);
+		if (isNegative) {
+			unitaryInv(z, z);
+		}
+	}
+	template<class tag2, size_t maxBitSize2>
+	static void powCyclotomic(Fp12T& z, const Fp12T& x, const FpT<tag2, maxBitSize2>& y)
+	{
+		fp::Block b;
+		y.getBlock(b);
+		powCyclotomicArray(z, x, b.p, b.n, false);
+	}
+	static void powCyclotomic(Fp12T& z, const Fp12T& x, const mpz_class& y)
+	{
+		powCyclotomicArray(z, x, gmp::getUnit(y), gmp::getUnitSize(y), y < 0);
+	}
 	/*
 		Frobenius
 		i^2 = -1
@@ -1088,17 +1238,74 @@ struct Fp12T : public fp::Serializable<Fp12T<Fp>,
 	template<class InputStream>
 	void load(InputStream& is, int ioMode = IoSerialize)
 	{
+		if (ioMode & IoTorus) {
+			Fp6 g;
+			g.load(is, ioMode);
+			setTorus(g);
+			return;
+		}
 		a.load(is, ioMode);
 		b.load(is, ioMode);
 	}
 	template<class OutputStream>
 	void save(OutputStream& os, int ioMode = IoSerialize) const
 	{
+		if (ioMode & IoTorus) {
+			Fp6 g;
+			getTorus(g);
+			g.save(os, ioMode);
+			return;
+		}
 		const char sep = *fp::getIoSeparator(ioMode);
 		a.save(os, ioMode);
 		if (sep) cybozu::writeChar(os, sep);
 		b.save(os, ioMode);
 	}
+	/*
+		torus T2 representation of x = a + bw in the cyclotomic subgroup (a^2 - b^2v = 1)
+		g = (1 + a) / b, x = (g + w) / (g - w)
+		g = 0 for x = 1 (x = -1 is not supported because it is not in GT)
+	*/
+	void getTorus(Fp6& g) const
+	{
+		if (b.isZero()) {
+			if (!a.isOne()) throw cybozu::Exception("Fp12T:getTorus:not supported") << *this;
+			g.clear();
+			return;
+		}
+		Fp6 t0, t1;
+		Fp6::sqr(t0, a);
+		Fp6::sqr(t1, b);
+		Fp2::mul_xi(t1.c, t1.c);
+		t0.a -= t1.c;
+		t0.b -= t1.a;
+		t0.c -= t1.b; // t0 = a^2 - b^2v
+		if (!t0.isOne()) throw cybozu::Exception("Fp12T:getTorus:not in the cyclotomic subgroup") << *this;
+		Fp6::inv(t0, b);
+		t1 = a;
+		t1.a.a += Fp::one();
+		Fp6::mul(g, t1, t0);
+	}
+	/*
+		x = (g + w) / (g - w) = ((g^2 + v) + 2gw) / (g^2 - v)
+		g^2 - v != 0 because v is not a square in Fp6
+	*/
+	void setTorus(const Fp6& g)
+	{
+		if (g.isZero()) {
+			*this = 1;
+			return;
+		}
+		Fp6 t0, t1;
+		Fp6::sqr(t0, g);
+		t1 = t0;
+		t0.b.a += Fp::one(); // g^2 + v
+		t1.b.a -= Fp::one(); // g^2 - v
+		Fp6::inv(t1, t1);
+		Fp6::mul(a, t0, t1);
+		Fp6::add(t0, g, g);
+		Fp6::mul(b, t0, t1);
+	}
 	friend std::istream& operator>>(std::istream& is, Fp12T& self)
 	{
 		self.load(is, fp::detectIoMode(Fp::BaseFp::getIoMode(), is));
@@ -1127,9 +1334,10 @@ struct GroupMtoA : public T {
 	{
 		T::mul(castT(z), castT(x), castT(y));
 	}
+	// assume the cyclotomic subgroup as neg
 	static void dbl(GroupMtoA& y, const GroupMtoA& x)
 	{
-		T::sqr(castT(y), castT(x));
+		T::sqrCyclotomic(castT(y), castT(x));
 	}
 	static void neg(GroupMtoA& y, const GroupMtoA& x)
 	{
@@ -1155,6 +1363,11 @@ struct GroupMtoA : public T {
 		add(*this, *this, rhs);
 	}
 	void normalize() {}
+	static void normalizeVec(GroupMtoA *y, const GroupMtoA *x, size_t n)
+	{
+		if (y == x) return;
+		for (size_t i = 0; i < n; i++) y[i] = x[i];
+	}
 private:
 	bool isOne() const;
 };
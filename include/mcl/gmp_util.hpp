@@ -543,9 +543,73 @@ bool getNAF(Vec& v, const mpz_class& x)
 } // mcl::gmp
 
 /*
-	Tonelli-Shanks
+	square root mod p
+	the mpz_class version uses Tonelli-Shanks
+	the Fp version is selected by p at set()
+	p = 3 mod 4 : a^((p + 1) / 4)
+	p = 5 mod 8 : Atkin's algorithm
+	otherwise   : Tonelli-Shanks
+	and it checks the result by squaring instead of computing Legendre symbol
+	the fixed exponents are converted to sliding window chains at set()
 */
 class SquareRoot {
+	static const int winBit = 5;
+	/*
+		(the number of sqr, odd digit) from the top
+		the digit of the last element is 0 if the exponent is even
+	*/
+	typedef std::vector<std::pair<int, int> > Chain;
+	static void makeChain(Chain& c, const mpz_class& e)
+	{
+		c.clear();
+		int i = (int)gmp::getBitSize(e) - 1;
+		int sqrN = 0;
+		while (i >= 0) {
+			if (!gmp::testBit(e, i)) {
+				sqrN++;
+				i--;
+				continue;
+			}
+			int j = i - winBit + 1;
+			if (j < 0) j = 0;
+			while (!gmp::testBit(e, j)) j++;
+			int d = 0;
+			for (int k = i; k >= j; k--) {
+				d = d * 2 + gmp::testBit(e, k);
+			}
+			sqrN += i - j + 1;
+			c.push_back(std::make_pair(sqrN, d));
+			sqrN = 0;
+			i = j - 1;
+		}
+		if (sqrN > 0) c.push_back(std::make_pair(sqrN, 0));
+	}
+	/*
+		z = x^e where c = makeChain(e)
+	*/
+	template<class Fp>
+	static void powChain(Fp& z, const Fp& x, const Chain& c)
+	{
+		if (c.empty()) {
+			z = 1;
+			return;
+		}
+		const size_t tblN = 1 << (winBit - 1);
+		Fp tbl[tblN]; // x, x^3, x^5, ...
+		Fp x2;
+		Fp::sqr(x2, x);
+		tbl[0] = x;
+		for (size_t i = 1; i < tblN; i++) {
+			Fp::mul(tbl[i], tbl[i - 1], x2);
+		}
+		z = tbl[c[0].second >> 1];
+		for (size_t i = 1; i < c.size(); i++) {
+			for (int j = 0; j < c[i].first; j++) {
+				Fp::sqr(z, z);
+			}
+			if (c[i].second) z *= tbl[c[i].second >> 1];
+		}
+	}
 	bool isPrime;
 	mpz_class p;
 	mpz_class g;
@@ -553,6 +617,9 @@ class SquareRoot {
 	mpz_class q; // p - 1 = 2^r q
 	mpz_class s; // s = g^q
 	mpz_class q_add_1_div_2;
+	Chain qChain;
+	Chain q_add_1_div_2Chain;
+	Chain p_sub_5_div_8Chain;
 public:
 	SquareRoot() { clear(); }
 	void clear()
@@ -564,6 +631,9 @@ public:
 		q = 0;
 		s = 0;
 		q_add_1_div_2 = 0;
+		qChain.clear();
+		q_add_1_div_2Chain.clear();
+		p_sub_5_div_8Chain.clear();
 	}
 	void set(const mpz_class& _p)
 	{
@@ -581,6 +651,22 @@ public:
 		}
 		gmp::powMod(s, g, q, p);
 		q_add_1_div_2 = (q + 1) / 2;
+		makeChain(qChain, q);
+		makeChain(q_add_1_div_2Chain, q_add_1_div_2);
+		if (r == 2) {
+			makeChain(p_sub_5_div_8Chain, (p - 5) / 8);
+		}
+	}
+	/*
+		x = a^((p + 1) / 4) for p = 3 mod 4
+		x^2 = a if a is a quadratic residue else x^2 = -a
+	*/
+	template<class Fp>
+	void powQuarter(Fp& x, const Fp& a) const
+	{
+		assert(r == 1);
+		// (p + 1) / 4 = (q + 1) / 2
+		powChain(x, a, q_add_1_div_2Chain);
 	}
 	/*
 		solve x^2 = a mod p
@@ -623,46 +709,67 @@ public:
 	}
 	/*
 		solve x^2 = a in Fp
+		x is not changed if a is not a quadratic residue
 	*/
 	template<class Fp>
 	bool get(Fp& x, const Fp& a) const
 	{
+		if (!isPrime) throw cybozu::Exception("SquareRoot:get:not prime") << p;
 		if (Fp::getOp().mp != p) throw cybozu::Exception("bad Fp") << Fp::getOp().mp << p;
-		if (a == 0) {
-			x = 0;
+		Fp t, u;
+		if (r == 1) {
+			powQuarter(t, a);
+			Fp::sqr(u, t);
+			if (u != a) return false;
+			x = t;
 			return true;
 		}
-		if (gmp::legendre(a.getMpz(), p) < 0) return false;
-		if (r == 1) {
-			// (p + 1) / 4 = (q + 1) / 2
-			Fp::pow(x, a, q_add_1_div_2);
+		if (r == 2) {
+			/*
+				b = (2a)^((p - 5) / 8), c = 2ab^2 (then c^2 = -1)
+				x = ab(c - 1)
+			*/
+			Fp a2, b;
+			Fp::add(a2, a, a);
+			powChain(b, a2, p_sub_5_div_8Chain);
+			Fp::sqr(t, b);
+			t *= a2;
+			t -= 1;
+			b *= a;
+			t *= b;
+			Fp::sqr(u, t);
+			if (u != a) return false;
+			x = t;
 			return true;
 		}
-		Fp c, d;
+		if (a.isZero()) {
+			x.clear();
+			return true;
+		}
+		Fp c, d, b;
 		c.setMpz(s);
 		int e = r;
-		Fp::pow(d, a, q);
-		Fp::pow(x, a, q_add_1_div_2); // destroy a if &x == &a
-		Fp dd;
-		Fp b;
+		powChain(d, a, qChain);
+		powChain(t, a, q_add_1_div_2Chain);
 		while (!d.isOne()) {
 			int i = 1;
-			Fp::sqr(dd, d);
-			while (!dd.isOne()) {
-				dd *= dd;
+			Fp::sqr(u, d);
+			while (!u.isOne()) {
 				i++;
+				if (i == e) return false; // a is not a quadratic residue
+				Fp::sqr(u, u);
 			}
-			b = 1;
-//			b <<= e - i - 1;
+			// b = c^(2^(e - i - 1))
+			b = c;
 			for (int j = 0; j < e - i - 1; j++) {
-				b += b;
+				Fp::sqr(b, b);
 			}
-			Fp::pow(b, c, b);
-			x *= b;
+			t *= b;
 			Fp::sqr(c, b);
 			d *= c;
 			e = i;
 		}
+		x = t;
 		return true;
 	}
 };
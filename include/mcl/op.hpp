@@ -81,6 +81,11 @@ namespace mcl {
 		[0] ; infinity
 		<x> ; for even y
 		<x>|1 ; for odd y ; |1 means set MSB of x
+
+	// for Fp12
+	IoTorus
+		<g> ; Fp6 value such that x = (g + w) / (g - w) for x in the cyclotomic subgroup
+		used with other modes for <g> ; IoSerialize | IoTorus is half of IoSerialize
 */
 enum IoMode {
 	IoAuto = 0, // dec or hex according to ios_base::fmtflags
@@ -96,7 +101,8 @@ enum IoMode {
 	IoEcCompY = 256, // 1-bit y representation of elliptic curve
 	IoSerialize = 512, // use MBS for 1-bit y
 	IoFixedSizeByteSeq = IoSerialize, // obsolete
-	IoEcProj = 1024 // projective or jacobi coordinate
+	IoEcProj = 1024, // projective or jacobi coordinate
+	IoTorus = 2048 // torus T2 representation of Fp12 in the cyclotomic subgroup
 };
 
 namespace fp {
@@ -117,6 +123,7 @@ typedef void (*void2uOp)(Unit*, const Unit*, const Op&);
 typedef void (*void3u)(Unit*, const Unit*, const Unit*);
 typedef void (*void4u)(Unit*, const Unit*, const Unit*, const Unit*);
 typedef int (*int2u)(Unit*, const Unit*);
+typedef int (*int1uOp)(const Unit*, const Op&);
 
 typedef Unit (*u1uII)(Unit*, Unit, Unit);
 typedef Unit (*u3u)(Unit*, const Unit*, const Unit*);
@@ -136,6 +143,18 @@ enum Mode {
 	FP_XBYAK
 };
 
+/*
+	algorithm of Fp::inv
+	INV_AUTO : JIT if available else INV_SAFEGCD for MCL_USE_VINT else INV_GMP
+	INV_GMP : mpz_invert (Vint::invMod if MCL_USE_VINT)
+	INV_SAFEGCD : constant-time divsteps on an array of Unit
+*/
+enum InvMode {
+	INV_AUTO,
+	INV_GMP,
+	INV_SAFEGCD
+};
+
 enum PrimeMode {
 	PM_GENERIC = 0,
 	PM_NICT_P192,
@@ -178,6 +197,7 @@ struct Op {
 	void4u fp_mul;
 	void3u fp_sqr;
 	void2uOp fp_invOp;
+	int1uOp fp_legendre;
 	void2uIu fp_mulUnit; // fpN1_mod + fp_mulUnitPre
 
 	void3u fpDbl_mulPre;
@@ -203,6 +223,7 @@ struct Op {
 	void3u fp2_sub;
 	void3u fp2_mul;
 	void4u fp2_mulNF;
+	void3u fp2_sqrNF;
 	void2u fp2_neg;
 	void2u fp2_inv;
 	void2u fp2_sqr;
@@ -249,6 +270,7 @@ struct Op {
 		fp_mul = 0;
 		fp_sqr = 0;
 		fp_invOp = 0;
+		fp_legendre = 0;
 		fp_mulUnit = 0;
 
 		fpDbl_mulPre = 0;
@@ -271,6 +293,7 @@ struct Op {
 		fp2_sub = 0;
 		fp2_mul = 0;
 		fp2_mulNF = 0;
+		fp2_sqrNF = 0;
 		fp2_neg = 0;
 		fp2_inv = 0;
 		fp2_sqr = 0;
@@ -297,8 +320,13 @@ struct Op {
 		*/
 		fp_mul(y, x, R2, p);
 	}
-	void init(const std::string& mstr, size_t maxBitSize, Mode mode, size_t mclMaxBitSize = MCL_MAX_BIT_SIZE);
+	void init(const std::string& mstr, size_t maxBitSize, Mode mode, InvMode invMode = INV_AUTO, size_t mclMaxBitSize = MCL_MAX_BIT_SIZE);
 	void initFp2(int xi_a);
+	/*
+		select fp_invOp
+		init() sets invMode
+	*/
+	void setInvMode(InvMode invMode);
 	static FpGenerator* createFpGenerator();
 	static void destroyFpGenerator(FpGenerator *fg);
 private:
@@ -140,17 +140,17 @@ struct Serializable : public E {
 		return str;
 	}
 	// return written bytes
-	size_t serialize(void *buf, size_t maxBufSize) const
+	size_t serialize(void *buf, size_t maxBufSize, int ioMode = IoSerialize) const
 	{
 		cybozu::MemoryOutputStream os(buf, maxBufSize);
-		static_cast<const T&>(*this).save(os);
+		static_cast<const T&>(*this).save(os, ioMode);
 		return os.getPos();
 	}
 	// return read bytes
-	size_t deserialize(const void *buf, size_t bufSize)
+	size_t deserialize(const void *buf, size_t bufSize, int ioMode = IoSerialize)
 	{
 		cybozu::MemoryInputStream is(buf, bufSize);
-		static_cast<T&>(*this).load(is);
+		static_cast<T&>(*this).load(is, ioMode);
 		return is.getPos();
 	}
 };
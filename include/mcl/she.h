@@ -82,6 +82,12 @@ MCLSHE_DLL_API mclSize sheCipherTextG1Serialize(void *buf, mclSize maxBufSize, c
 MCLSHE_DLL_API mclSize sheCipherTextG2Serialize(void *buf, mclSize maxBufSize, const sheCipherTextG2 *c);
 MCLSHE_DLL_API mclSize sheCipherTextGTSerialize(void *buf, mclSize maxBufSize, const sheCipherTextGT *c);
 MCLSHE_DLL_API mclSize sheZkpBinSerialize(void *buf, mclSize maxBufSize, const sheZkpBin *zkp);
+/*
+	torus representation of each GT ; half of sheCipherTextGTSerialize
+	c must not be the output of sheMulML before sheFinalExpGT
+	return written byte size if success else 0
+*/
+MCLSHE_DLL_API mclSize sheCipherTextGTSerializeTorus(void *buf, mclSize maxBufSize, const sheCipherTextGT *c);
 
 // return read byte size if sucess else 0
 MCLSHE_DLL_API mclSize sheSecretKeyDeserialize(sheSecretKey* sec, const void *buf, mclSize bufSize);
@@ -90,6 +96,8 @@ MCLSHE_DLL_API mclSize sheCipherTextG1Deserialize(sheCipherTextG1* c, const void
 MCLSHE_DLL_API mclSize sheCipherTextG2Deserialize(sheCipherTextG2* c, const void *buf, mclSize bufSize);
 MCLSHE_DLL_API mclSize sheCipherTextGTDeserialize(sheCipherTextGT* c, const void *buf, mclSize bufSize);
 MCLSHE_DLL_API mclSize sheZkpBinDeserialize(sheZkpBin* zkp, const void *buf, mclSize bufSize);
+// read the output of sheCipherTextGTSerializeTorus ; return read byte size if success else 0
+MCLSHE_DLL_API mclSize sheCipherTextGTDeserializeTorus(sheCipherTextGT* c, const void *buf, mclSize bufSize);
 
 /*
 	set secretKey if system has /dev/urandom or CryptGenRandom
@@ -101,6 +109,7 @@ MCLSHE_DLL_API void sheGetPublicKey(shePublicKey *pub, const sheSecretKey *sec);
 
 /*
 	make table to decode DLP
+	use all threads if the library is built with MCL_USE_OMP=1
 	return 0 if success
 */
 MCLSHE_DLL_API int sheSetRangeForDLP(mclSize hashSize);
@@ -108,6 +117,17 @@ MCLSHE_DLL_API int sheSetRangeForG1DLP(mclSize hashSize);
 MCLSHE_DLL_API int sheSetRangeForG2DLP(mclSize hashSize);
 MCLSHE_DLL_API int sheSetRangeForGTDLP(mclSize hashSize);
 
+/*
+	make table to decode DLP for |m| < 2^(bitSize - 1) by the kangaroo method
+	it is used if the table made by sheSetRangeFor*DLP fails
+	tblSize is the number of entries (16 bytes each)
+	clear the table if bitSize = 0
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheSetKangarooRangeForG1DLP(mclSize bitSize, mclSize tblSize);
+MCLSHE_DLL_API int sheSetKangarooRangeForG2DLP(mclSize bitSize, mclSize tblSize);
+MCLSHE_DLL_API int sheSetKangarooRangeForGTDLP(mclSize bitSize, mclSize tblSize);
+
 /*
 	set tryNum to decode DLP
 */
@@ -130,6 +150,14 @@ MCLSHE_DLL_API void sheUseDecG2ViaGT(int use);
 MCLSHE_DLL_API mclSize sheLoadTableForG1DLP(const void *buf, mclSize bufSize);
 MCLSHE_DLL_API mclSize sheLoadTableForG2DLP(const void *buf, mclSize bufSize);
 MCLSHE_DLL_API mclSize sheLoadTableForGTDLP(const void *buf, mclSize bufSize);
+/*
+	map the table file for DLP saved by sheSaveTableFor*DLP read-only without copy
+	the processes mapping the same file share the memory
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheMapTableForG1DLP(const char *path);
+MCLSHE_DLL_API int sheMapTableForG2DLP(const char *path);
+MCLSHE_DLL_API int sheMapTableForGTDLP(const char *path);
 
 /*
 	save table for DLP
@@ -157,6 +185,15 @@ MCLSHE_DLL_API int sheEncWithZkpBinG2(sheCipherTextG2 *c, sheZkpBin *zkp, const
 MCLSHE_DLL_API int sheDecG1(mclInt *m, const sheSecretKey *sec, const sheCipherTextG1 *c);
 MCLSHE_DLL_API int sheDecG2(mclInt *m, const sheSecretKey *sec, const sheCipherTextG2 *c);
 MCLSHE_DLL_API int sheDecGT(mclInt *m, const sheSecretKey *sec, const sheCipherTextGT *c);
+/*
+	decode c[i] and set m[i] for i in [0, n)
+	status[i] = 0 if c[i] is decoded else -1 (m[i] = 0)
+	use OpenMP threads if the library is built with MCL_USE_OMP
+	return 0 if all of c[] are decoded
+*/
+MCLSHE_DLL_API int sheDecG1Vec(mclInt *m, int *status, const sheSecretKey *sec, const sheCipherTextG1 *c, mclSize n);
+MCLSHE_DLL_API int sheDecG2Vec(mclInt *m, int *status, const sheSecretKey *sec, const sheCipherTextG2 *c, mclSize n);
+MCLSHE_DLL_API int sheDecGTVec(mclInt *m, int *status, const sheSecretKey *sec, const sheCipherTextGT *c, mclSize n);
 /*
 	verify zkp
 	return 1 if valid
@@ -197,6 +234,15 @@ MCLSHE_DLL_API int sheMulG1(sheCipherTextG1 *z, const sheCipherTextG1 *x, mclInt
 MCLSHE_DLL_API int sheMulG2(sheCipherTextG2 *z, const sheCipherTextG2 *x, mclInt y);
 MCLSHE_DLL_API int sheMulGT(sheCipherTextGT *z, const sheCipherTextGT *x, mclInt y);
 
+/*
+	z = w[0] x[0] + ... + w[n-1] x[n-1] by a multi-scalar multiplication
+	faster than sheMul and sheAdd for short w[i] and large n
+	use OpenMP threads if the library is built with MCL_USE_OMP
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheLinearCombinationG1(sheCipherTextG1 *z, const sheCipherTextG1 *x, const mclInt *w, mclSize n);
+MCLSHE_DLL_API int sheLinearCombinationG2(sheCipherTextG2 *z, const sheCipherTextG2 *x, const mclInt *w, mclSize n);
+
 // return 0 if success
 // z = x * y
 MCLSHE_DLL_API int sheMul(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y);
@@ -207,6 +253,12 @@ MCLSHE_DLL_API int sheMul(sheCipherTextGT *z, const sheCipherTextG1 *x, const sh
 */
 MCLSHE_DLL_API int sheMulML(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y);
 MCLSHE_DLL_API int sheFinalExpGT(sheCipherTextGT *y, const sheCipherTextGT *x);
+/*
+	z = sheMul(x[0], y[0]) + ... + sheMul(x[n-1], y[n-1]) by one sheFinalExpGT
+	use OpenMP threads if the library is built with MCL_USE_OMP
+	return 0 if success
+*/
+MCLSHE_DLL_API int sheInnerProduct(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y, mclSize n);
 
 // return 0 if success
 // rerandomize(c)
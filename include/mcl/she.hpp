@@ -9,7 +9,9 @@
 */
 #include <cmath>
 #include <vector>
+#include <algorithm>
 #include <iosfwd>
+#include <string.h>
 #ifndef MCLBN_FP_UNIT_SIZE
 	#define MCLBN_FP_UNIT_SIZE 4
 #endif
@@ -34,6 +36,18 @@ namespace bn_current = mcl::bn512;
 
 #include <mcl/window_method.hpp>
 #include <cybozu/endian.hpp>
+#include <cybozu/xorshift.hpp>
+#ifdef _WIN32
+	#ifndef WIN32_LEAN_AND_MEAN
+		#define WIN32_LEAN_AND_MEAN
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
 
 namespace mcl { namespace she {
 
@@ -43,8 +57,30 @@ namespace local {
 	#define MCLSHE_WIN_SIZE 10
 #endif
 static const size_t winSize = MCLSHE_WIN_SIZE;
+/*
+	window size of the fixed-base tables of PrecomputedPublicKey
+	the GLV split makes them smaller than WindowMethod with winSize by a factor of about 2 splitN
+*/
+static const size_t fixedBaseWinSize = MCLSHE_WIN_SIZE + 1;
 static const size_t defaultTryNum = 1024;
+static const size_t normalizeBlockSize = 1024; // for HashTable::init
+static const size_t bucketLoad = 8; // average number of entries in a bucket of HashTable (8 bytes per entry)
+static const size_t giantBlockSize = 64; // number of giant steps hashed at once in HashTable::log
+static const size_t maxGiantTblSize = 4096; // max number of precomputed giant steps
+static const size_t defaultKangarooTblSize = 4096;
+static const size_t innerProductBlockSize = 64; // number of G2 elements precomputed at once in CipherTextGT::innerProduct
+/*
+	version of the saved HashTable
+	saved in the place of the size of KeyCount[] of the old format
+*/
+static const size_t hashTableVersionMask = 0x80000000u;
+static const size_t hashTableVersion = 1;
+static const size_t cacheLineSize = 64;
+static const size_t maxHashTableHeaderSize = 4096;
 
+/*
+	entry of the old format of HashTable
+*/
 struct KeyCount {
 	uint32_t key;
 	int32_t count; // power
@@ -58,6 +94,156 @@ struct KeyCount {
 	}
 };
 
+/*
+	a cache line of the open-addressing table of HashTable
+	fp[i] is the lower 16 bits of the hash of |count[i]| P
+	continue to the next bucket if the bucket is full (n == N)
+*/
+struct Bucket {
+	static const size_t N = 10;
+	uint16_t fp[N];
+	uint16_t n;
+	uint16_t reserved;
+	int32_t count[N]; // power
+};
+
+/*
+	read-only memory mapped file
+*/
+class MappedFile {
+	const void *p_;
+	size_t size_;
+	MappedFile(const MappedFile&);
+	void operator=(const MappedFile&);
+public:
+	MappedFile() : p_(0), size_(0) {}
+	~MappedFile() { close(); }
+	void open(const std::string& path)
+	{
+		close();
+#ifdef _WIN32
+		HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (hFile == INVALID_HANDLE_VALUE) throw cybozu::Exception("MappedFile:open") << path;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(hFile, &size) || size.QuadPart == 0) {
+			CloseHandle(hFile);
+			throw cybozu::Exception("MappedFile:bad size") << path;
+		}
+		HANDLE hMap = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+		CloseHandle(hFile);
+		if (hMap == NULL) throw cybozu::Exception("MappedFile:CreateFileMapping") << path;
+		void *p = MapViewOfFile(hMap, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(hMap);
+		if (p == NULL) throw cybozu::Exception("MappedFile:MapViewOfFile") << path;
+		size_ = size_t(size.QuadPart);
+#else
+		int fd = ::open(path.c_str(), O_RDONLY);
+		if (fd < 0) throw cybozu::Exception("MappedFile:open") << path;
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size == 0) {
+			::close(fd);
+			throw cybozu::Exception("MappedFile:bad size") << path;
+		}
+		void *p = mmap(0, size_t(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+		::close(fd);
+		if (p == MAP_FAILED) throw cybozu::Exception("MappedFile:mmap") << path;
+		size_ = size_t(st.st_size);
+#endif
+		p_ = p;
+	}
+	void close()
+	{
+		if (p_ == 0) return;
+#ifdef _WIN32
+		UnmapViewOfFile(p_);
+#else
+		munmap(const_cast<void*>(p_), size_);
+#endif
+		p_ = 0;
+		size_ = 0;
+	}
+	const void *get() const { return p_; }
+	size_t size() const { return size_; }
+};
+
+/*
+	array of Bucket aligned to the cache line
+	owns the memory or refers to an external one (e.g. a mapped file) without copy
+	a copy always owns the memory
+*/
+class BucketVec {
+	std::vector<char> buf_;
+	MappedFile *map_; // owned if not null
+	const Bucket *p_;
+	size_t n_;
+	void clearMap()
+	{
+		delete map_;
+		map_ = 0;
+	}
+public:
+	BucketVec() : map_(0), p_(0), n_(0) {}
+	BucketVec(const BucketVec& rhs) : map_(0), p_(0), n_(0) { *this = rhs; }
+	~BucketVec() { clearMap(); }
+	BucketVec& operator=(const BucketVec& rhs)
+	{
+		if (this == &rhs) return *this;
+		resize(rhs.n_);
+		if (n_) memcpy(data(), rhs.data(), n_ * sizeof(Bucket));
+		return *this;
+	}
+	/*
+		allocate the owned memory
+		all buckets are cleared
+	*/
+	void resize(size_t n)
+	{
+		clearMap();
+		buf_.clear();
+		n_ = n;
+		p_ = 0;
+		if (n == 0) return;
+		buf_.resize(n * sizeof(Bucket) + local::cacheLineSize);
+		size_t offset = size_t(uintptr_t(&buf_[0]) % local::cacheLineSize);
+		if (offset) offset = local::cacheLineSize - offset;
+		p_ = reinterpret_cast<const Bucket*>(&buf_[offset]);
+	}
+	/*
+		refer to p[0, n) and take map if not null
+	*/
+	void setView(const Bucket *p, size_t n, MappedFile *map)
+	{
+		clearMap();
+		buf_.clear();
+		map_ = map;
+		p_ = p;
+		n_ = n;
+	}
+	bool isView() const { return n_ > 0 && buf_.empty(); }
+	size_t size() const { return n_; }
+	Bucket *data()
+	{
+		assert(!isView());
+		return const_cast<Bucket*>(p_);
+	}
+	const Bucket *data() const { return p_; }
+	Bucket& operator[](size_t i) { return data()[i]; }
+	const Bucket& operator[](size_t i) const { return p_[i]; }
+	bool operator==(const BucketVec& rhs) const
+	{
+		return n_ == rhs.n_ && (n_ == 0 || memcmp(p_, rhs.p_, n_ * sizeof(Bucket)) == 0);
+	}
+};
+
+inline void prefetch(const void *p)
+{
+#if defined(__GNUC__)
+	__builtin_prefetch(p);
+#else
+	(void)p;
+#endif
+}
+
 template<class G, bool = true>
 struct InterfaceForHashTable : G {
 	static G& castG(InterfaceForHashTable& x) { return static_cast<G&>(x); }
@@ -68,8 +254,86 @@ struct InterfaceForHashTable : G {
 	static bool isZero(const G& P) { return P.isZero(); }
 	static bool isSameX(const G& P, const G& Q) { return P.x == Q.x; }
 	static uint32_t getHash(const G& P) { return uint32_t(*P.x.getUnit()); }
+	/*
+		hSub[i] = getHash(P - Q[i]), hAdd[i] = getHash(P + Q[i])
+		P and Q[i] are normalized and not zero
+		isSpecial[i] = true and the hashes are not set if P = Q[i] or -Q[i]
+		compute only x of the affine additions with one inversion
+	*/
+	static void getHashSubAddVec(uint32_t *hSub, uint32_t *hAdd, bool *isSpecial, const G& P, const G *Q, size_t n)
+	{
+		typedef typename G::Fp F;
+		std::vector<F> d(n);
+		for (size_t i = 0; i < n; i++) {
+			F::sub(d[i], Q[i].x, P.x);
+			isSpecial[i] = d[i].isZero();
+		}
+		F::invVec(&d[0], &d[0], n);
+		F L, x;
+		for (size_t i = 0; i < n; i++) {
+			if (isSpecial[i]) continue;
+			// P + Q[i] ; L = (Q.y - P.y) / (Q.x - P.x)
+			F::sub(L, Q[i].y, P.y);
+			L *= d[i];
+			F::sqr(x, L);
+			x -= P.x;
+			x -= Q[i].x;
+			hAdd[i] = uint32_t(*x.getUnit());
+			// P - Q[i] ; L = -(Q.y + P.y) / (Q.x - P.x)
+			F::add(L, Q[i].y, P.y);
+			L *= d[i];
+			F::sqr(x, L);
+			x -= P.x;
+			x -= Q[i].x;
+			hSub[i] = uint32_t(*x.getUnit());
+		}
+	}
+	/*
+		kc[i] = KeyCount of P + Q[i] = (x + i)P
+		P and Q[i] are normalized and P + Q[i] is not zero
+		compute the affine additions with one inversion
+	*/
+	static void getKeyCountAddVec(KeyCount *kc, int x, const G& P, const G *Q, size_t n)
+	{
+		typedef typename G::Fp F;
+		std::vector<F> d(n);
+		for (size_t i = 0; i < n; i++) {
+			F::sub(d[i], Q[i].x, P.x);
+		}
+		F::invVec(&d[0], &d[0], n);
+		F L, X, Y;
+		for (size_t i = 0; i < n; i++) {
+			bool odd;
+			if (d[i].isZero()) {
+				// P = Q[i]
+				G R;
+				G::add(R, P, Q[i]);
+				R.normalize();
+				kc[i].key = getHash(R);
+				odd = isOdd(R);
+			} else {
+				// L = (Q.y - P.y) / (Q.x - P.x), X = L^2 - P.x - Q.x, Y = L(P.x - X) - P.y
+				F::sub(L, Q[i].y, P.y);
+				L *= d[i];
+				F::sqr(X, L);
+				X -= P.x;
+				X -= Q[i].x;
+				F::sub(Y, P.x, X);
+				Y *= L;
+				Y -= P.y;
+				kc[i].key = uint32_t(*X.getUnit());
+				odd = Y.isOdd();
+			}
+			kc[i].count = odd ? x + int(i) : -(x + int(i));
+		}
+	}
 	static void clear(G& P) { P.clear(); }
 	static void normalize(G& P) { P.normalize(); }
+	static void normalizeVec(G *Q, const G *P, size_t n) { G::normalizeVec(Q, P, n); }
+	static void normalizeVec(InterfaceForHashTable *Q, const InterfaceForHashTable *P, size_t n)
+	{
+		G::normalizeVec(reinterpret_cast<G*>(Q), reinterpret_cast<const G*>(P), n);
+	}
 	static void dbl(G& Q, const G& P) { G::dbl(Q, P); }
 	static void neg(G& Q, const G& P) { G::neg(Q, P); }
 	static void add(G& R, const G& P, const G& Q) { G::add(R, P, Q); }
@@ -92,9 +356,93 @@ struct InterfaceForHashTable<G, false> : G {
 	static bool isZero(const G& x) { return x.isOne(); }
 	static bool isSameX(const G& x, const G& Q) { return x.a == Q.a; }
 	static uint32_t getHash(const G& x) { return uint32_t(*x.getFp0()->getUnit()); }
+	/*
+		hSub[i] = getHash(x / Q[i]), hAdd[i] = getHash(x Q[i]) for unitary Q[i]
+		compute only the hashed coefficient of the products
+		x = a + bw, Q[i] = c + dw, the coefficient of 1 of (ac + bdv) is A + B where
+		A = a0 c0 + xi(a1 c2 + a2 c1), B = xi(b0 d2 + b1 d1 + b2 d0)
+		and it is A - B for 1 / Q[i] = c - dw
+		isSpecial[i] = true if a hash is equal to that of 1 (the product may be 1)
+	*/
+	static void getHashSubAddVec(uint32_t *hSub, uint32_t *hAdd, bool *isSpecial, const G& x, const G *Q, size_t n)
+	{
+		typedef typename G::Fp2 Fp2;
+		G one;
+		clear(one);
+		const uint32_t hOne = getHash(one);
+		Fp2 A, B, t;
+		for (size_t i = 0; i < n; i++) {
+			const G& y = Q[i];
+			Fp2::mul(A, x.a.b, y.a.c);
+			Fp2::mul(t, x.a.c, y.a.b);
+			A += t;
+			Fp2::mul_xi(A, A);
+			Fp2::mul(t, x.a.a, y.a.a);
+			A += t;
+			Fp2::mul(B, x.b.a, y.b.c);
+			Fp2::mul(t, x.b.b, y.b.b);
+			B += t;
+			Fp2::mul(t, x.b.c, y.b.a);
+			B += t;
+			Fp2::mul_xi(B, B);
+			Fp2::sub(t, A, B);
+			hSub[i] = uint32_t(*t.a.getUnit());
+			Fp2::add(t, A, B);
+			hAdd[i] = uint32_t(*t.a.getUnit());
+			isSpecial[i] = hSub[i] == hOne || hAdd[i] == hOne;
+		}
+	}
+	/*
+		kc[i] = KeyCount of x Q[i] = g^(c + i)
+		compute only the coefficients of 1 and w of the products
+		x = a + bw, Q[i] = c + dw, the coefficient of w of the product is
+		(ad + bc).a = a0 d0 + xi(a1 d2 + a2 d1) + b0 c0 + xi(b1 c2 + b2 c1)
+	*/
+	static void getKeyCountAddVec(KeyCount *kc, int c, const G& x, const G *Q, size_t n)
+	{
+		typedef typename G::Fp2 Fp2;
+		Fp2 A, B, t;
+		for (size_t i = 0; i < n; i++) {
+			const G& y = Q[i];
+			// coefficient of 1
+			Fp2::mul(A, x.a.b, y.a.c);
+			Fp2::mul(t, x.a.c, y.a.b);
+			A += t;
+			Fp2::mul(t, x.b.a, y.b.c);
+			A += t;
+			Fp2::mul(t, x.b.b, y.b.b);
+			A += t;
+			Fp2::mul(t, x.b.c, y.b.a);
+			A += t;
+			Fp2::mul_xi(A, A);
+			Fp2::mul(t, x.a.a, y.a.a);
+			A += t;
+			// coefficient of w
+			Fp2::mul(B, x.a.b, y.b.c);
+			Fp2::mul(t, x.a.c, y.b.b);
+			B += t;
+			Fp2::mul(t, x.b.b, y.a.c);
+			B += t;
+			Fp2::mul(t, x.b.c, y.a.b);
+			B += t;
+			Fp2::mul_xi(B, B);
+			Fp2::mul(t, x.a.a, y.b.a);
+			B += t;
+			Fp2::mul(t, x.b.a, y.a.a);
+			B += t;
+			kc[i].key = uint32_t(*A.a.getUnit());
+			kc[i].count = B.a.isOdd() ? c + int(i) : -(c + int(i));
+		}
+	}
 	static void clear(G& x) { x = 1; }
 	static void normalize(G&) { }
-	static void dbl(G& y, const G& x) { G::sqr(y, x); }
+	template<class T>
+	static void normalizeVec(T *y, const T *x, size_t n)
+	{
+		if (y == x) return;
+		for (size_t i = 0; i < n; i++) y[i] = x[i];
+	}
+	static void dbl(G& y, const G& x) { G::sqrCyclotomic(y, x); }
 	static void neg(G& Q, const G& P) { G::unitaryInv(Q, P); }
 	static void add(G& z, const G& x, const G& y) { G::mul(z, x, y); }
 	template<class INT>
@@ -109,107 +457,247 @@ template<>char GtoChar<bn_current::GT>() { return 'T'; }
 
 /*
 	HashTable<EC, true> or HashTable<Fp12, false>
+	open-addressing table of the hashes of xP for 1 <= x <= hashSize
+	a key of 32 bits selects the bucket by the upper bits and the fingerprint is the lower 16 bits
 */
 template<class G, bool isEC = true>
 class HashTable {
 	typedef InterfaceForHashTable<G, isEC> I;
 	typedef std::vector<KeyCount> KeyCountVec;
-	KeyCountVec kcv_;
+	size_t hashSize_;
+	BucketVec tbl_;
 	G P_;
 	mcl::fp::WindowMethod<I> wm_;
 	G nextP_;
-	G nextNegP_;
 	size_t tryNum_;
+	std::vector<G> giantTbl_; // giantTbl_[i] = (i + 1) nextP_ (normalized)
 	void setWindowMethod()
 	{
 		const size_t bitSize = G::BaseFp::BaseFp::getBitSize();
 		wm_.init(static_cast<const I&>(P_), bitSize, local::winSize);
 	}
+	void initGiantTbl()
+	{
+		giantTbl_.clear();
+		if (hashSize_ == 0 || tryNum_ <= 1) return;
+		giantTbl_.resize((std::min)(tryNum_ - 1, local::maxGiantTblSize));
+		giantTbl_[0] = nextP_;
+		for (size_t i = 1; i < giantTbl_.size(); i++) {
+			I::add(giantTbl_[i], giantTbl_[i - 1], nextP_);
+		}
+		I::normalizeVec(&giantTbl_[0], &giantTbl_[0], giantTbl_.size());
+	}
+	void initTbl(size_t hashSize)
+	{
+		hashSize_ = hashSize;
+		tbl_.resize((hashSize + local::bucketLoad - 1) / local::bucketLoad);
+		if (tbl_.size()) memset(tbl_.data(), 0, tbl_.size() * sizeof(Bucket));
+	}
+	size_t getPos(uint32_t key) const
+	{
+		return size_t((uint64_t(key) * tbl_.size()) >> 32);
+	}
+	void insert(uint32_t key, int count)
+	{
+		size_t pos = getPos(key);
+		for (;;) {
+			Bucket& b = tbl_[pos];
+			if (b.n < Bucket::N) {
+				b.fp[b.n] = uint16_t(key);
+				b.count[b.n] = count;
+				b.n++;
+				return;
+			}
+			if (++pos == tbl_.size()) pos = 0;
+		}
+	}
+	/*
+		append count whose fingerprint is equal to key
+	*/
+	void appendCandidate(std::vector<int>& cv, uint32_t key) const
+	{
+		if (tbl_.size() == 0) return;
+		const uint16_t fp = uint16_t(key);
+		size_t pos = getPos(key);
+		// at most tbl_.size() buckets for a broken table
+		for (size_t j = 0; j < tbl_.size(); j++) {
+			const Bucket& b = tbl_[pos];
+			const size_t n = (std::min)(size_t(b.n), Bucket::N);
+			for (size_t i = 0; i < n; i++) {
+				if (b.fp[i] == fp) cv.push_back(b.count[i]);
+			}
+			if (n < Bucket::N) return;
+			if (++pos == tbl_.size()) pos = 0;
+		}
+	}
+	void prefetchBucket(uint32_t key) const
+	{
+		local::prefetch(&tbl_[getPos(key)]);
+	}
+	/*
+		log_P(T) for normalized T and count in {c, -c : c in candidate}
+	*/
+	static int getLog(const G& cP, const G& T, int count)
+	{
+		const bool neg = count < 0;
+		if (I::isOdd(cP) ^ I::isOdd(T) ^ neg) return -count;
+		return count;
+	}
+	/*
+		verify all candidates cv[] of the probes at once
+		the probe of cv[i] is Pa + Q[idx[i]] if isAdd[i] else Ps - Q[idx[i]]
+		return true and set (k, c) if log_P(the probe of cv[k]) = c
+	*/
+	bool verify(size_t& k, int& c, const G& Ps, const G& Pa, const G *Q, const std::vector<size_t>& idx, const std::vector<bool>& isAdd, const std::vector<int>& cv) const
+	{
+		const size_t n = cv.size();
+		if (n == 0) return false;
+		std::vector<G> R(n * 2); // R[2i] = probe, R[2i + 1] = |cv[i]|P
+		for (size_t i = 0; i < n; i++) {
+			const size_t j = idx[i];
+			if (isAdd[i]) {
+				I::add(R[i * 2], Pa, Q[j]);
+			} else {
+				G N;
+				I::neg(N, Q[j]);
+				I::add(R[i * 2], Ps, N);
+			}
+			mulByWindowMethod(R[i * 2 + 1], std::abs(cv[i]));
+		}
+		I::normalizeVec(&R[0], &R[0], n * 2);
+		for (size_t i = 0; i < n; i++) {
+			if (I::isSameX(R[i * 2 + 1], R[i * 2])) {
+				k = i;
+				c = getLog(R[i * 2 + 1], R[i * 2], cv[i]);
+				return true;
+			}
+		}
+		return false;
+	}
+	/*
+		kcv[x - begin] = KeyCount of (x + 1)P for begin <= x < end
+		stepTbl[j] = (j + 1)P (normalized)
+		compute a block of xP from the previous one at once
+	*/
+	void initRange(KeyCount *kcv, const std::vector<G>& stepTbl, size_t begin, size_t end) const
+	{
+		const size_t blockSize = stepTbl.size();
+		G S; // xP
+		for (size_t x = begin; x < end; x += blockSize) {
+			const size_t n = (std::min)(blockSize, end - x);
+			if (x == 0) {
+				for (size_t j = 0; j < n; j++) {
+					const int c = int(j + 1);
+					kcv[j].key = I::getHash(stepTbl[j]);
+					kcv[j].count = I::isOdd(stepTbl[j]) ? c : -c;
+				}
+				S = stepTbl[n - 1];
+				continue;
+			}
+			if (x == begin) {
+				I::mul(S, P_, x);
+				I::normalize(S);
+			}
+			I::getKeyCountAddVec(&kcv[x - begin], int(x + 1), S, &stepTbl[0], n);
+			I::add(S, S, stepTbl[n - 1]);
+			I::normalize(S);
+		}
+	}
+	/*
+		multi-threaded initRange for [0, kcv.size()) with OpenMP
+		the ranges are aligned to the size of stepTbl
+	*/
+	void initKeyCount(KeyCountVec& kcv, const std::vector<G>& stepTbl, size_t cpuN) const
+	{
+		const size_t n = kcv.size();
+#ifdef MCL_USE_OMP
+		const size_t blockSize = stepTbl.size();
+		const size_t blockN = n / blockSize;
+		if (cpuN == 0) cpuN = omp_get_max_threads();
+		if (cpuN > blockN) cpuN = blockN;
+		if (cpuN > 1) {
+			#pragma omp parallel for num_threads(int(cpuN))
+			for (int i = 0; i < int(cpuN); i++) {
+				const size_t begin = blockN * i / cpuN * blockSize;
+				const size_t end = i == int(cpuN) - 1 ? n : blockN * (i + 1) / cpuN * blockSize;
+				initRange(&kcv[begin], stepTbl, begin, end);
+			}
+			return;
+		}
+#else
+		(void)cpuN;
+#endif
+		initRange(&kcv[0], stepTbl, 0, n);
+	}
 public:
-	HashTable() : tryNum_(local::defaultTryNum) {}
+	HashTable() : hashSize_(0), tryNum_(local::defaultTryNum) {}
 	bool operator==(const HashTable& rhs) const
 	{
-		if (kcv_.size() != rhs.kcv_.size()) return false;
-		for (size_t i = 0; i < kcv_.size(); i++) {
-			if (!kcv_[i].isSame(rhs.kcv_[i])) return false;
-		}
+		if (hashSize_ != rhs.hashSize_ || !(tbl_ == rhs.tbl_)) return false;
 		return P_ == rhs.P_ && nextP_ == rhs.nextP_;
 	}
 	bool operator!=(const HashTable& rhs) const { return !operator==(rhs); }
 	/*
 		compute log_P(xP) for |x| <= hashSize * tryNum
+		split [1, hashSize] into cpuN ranges computed with OpenMP (MCL_USE_OMP=1)
+		use omp_get_max_threads() if cpuN = 0
+		the table does not depend on cpuN
 	*/
-	void init(const G& P, size_t hashSize, size_t tryNum = local::defaultTryNum)
+	void init(const G& P, size_t hashSize, size_t tryNum = local::defaultTryNum, size_t cpuN = 0)
 	{
 		if (hashSize == 0) {
-			kcv_.clear();
+			initTbl(0);
+			giantTbl_.clear();
 			return;
 		}
 		if (hashSize >= 0x80000000u) throw cybozu::Exception("HashTable:init:hashSize is too large");
 		P_ = P;
 		tryNum_ = tryNum;
-		kcv_.resize(hashSize);
-		G xP;
-		I::clear(xP);
-		for (int i = 1; i <= (int)kcv_.size(); i++) {
-			I::add(xP, xP, P_);
-			I::normalize(xP);
-			kcv_[i - 1].key = I::getHash(xP);
-			kcv_[i - 1].count = I::isOdd(xP) ? i : -i;
-		}
-		nextP_ = xP;
-		I::dbl(nextP_, nextP_);
-		I::add(nextP_, nextP_, P_); // nextP = (hasSize * 2 + 1)P
-		I::neg(nextNegP_, nextP_); // nextNegP = -nextP
-		/*
-			ascending order of abs(count) for same key
-		*/
-		std::stable_sort(kcv_.begin(), kcv_.end());
+		initTbl(hashSize);
+		const size_t blockSize = (std::min)(hashSize, local::normalizeBlockSize);
+		std::vector<G> stepTbl(blockSize);
+		stepTbl[0] = P_;
+		for (size_t i = 1; i < blockSize; i++) {
+			I::add(stepTbl[i], stepTbl[i - 1], P_);
+		}
+		I::normalizeVec(&stepTbl[0], &stepTbl[0], blockSize);
+		KeyCountVec kcv(hashSize);
+		initKeyCount(kcv, stepTbl, cpuN);
+		// insert in the order of x to make the same table
+		for (size_t i = 0; i < hashSize; i++) {
+			insert(kcv[i].key, kcv[i].count);
+		}
+		I::mul(nextP_, P_, hashSize * 2 + 1);
 		setWindowMethod();
+		initGiantTbl();
 	}
 	void setTryNum(size_t tryNum)
 	{
 		this->tryNum_ = tryNum;
+		initGiantTbl();
 	}
 	/*
 		log_P(xP)
-		find range which has same hash of xP in kcv_,
+		find the counts which have the same fingerprint of xP in tbl_,
 		and detect it
 	*/
 	int basicLog(G xP, bool *ok = 0) const
 	{
 		if (ok) *ok = true;
 		if (I::isZero(xP)) return 0;
-		typedef KeyCountVec::const_iterator Iter;
-		KeyCount kc;
 		I::normalize(xP);
-		kc.key = I::getHash(xP);
-		kc.count = 0;
-		std::pair<Iter, Iter> p = std::equal_range(kcv_.begin(), kcv_.end(), kc);
-		G Q;
-		I::clear(Q);
-		int prev = 0;
-		/*
-			check range which has same hash
-		*/
-		while (p.first != p.second) {
-			int count = p.first->count;
-			int abs_c = std::abs(count);
-			assert(abs_c >= prev); // assume ascending order
-			bool neg = count < 0;
-			G T;
-//			I::mul(T, P, abs_c - prev);
-			mulByWindowMethod(T, abs_c - prev);
-			I::add(Q, Q, T);
-			I::normalize(Q);
-			if (I::isSameX(Q, xP)) {
-				bool QisOdd = I::isOdd(Q);
-				bool xPisOdd = I::isOdd(xP);
-				if (QisOdd ^ xPisOdd ^ neg) return -count;
-				return count;
+		std::vector<int> cv;
+		appendCandidate(cv, I::getHash(xP));
+		if (!cv.empty()) {
+			std::vector<G> T(cv.size());
+			for (size_t i = 0; i < cv.size(); i++) {
+//				I::mul(T[i], P, std::abs(cv[i]));
+				mulByWindowMethod(T[i], std::abs(cv[i]));
+			}
+			I::normalizeVec(&T[0], &T[0], T.size());
+			for (size_t i = 0; i < cv.size(); i++) {
+				if (I::isSameX(T[i], xP)) return getLog(T[i], xP, cv[i]);
 			}
-			prev = abs_c;
-			++p.first;
 		}
 		if (ok) {
 			*ok = false;
@@ -219,7 +707,8 @@ public:
 	}
 	/*
 		compute log_P(xP)
-		call basicLog at most 2 * tryNum
+		probe xP -+ i nextP for 1 <= i < tryNum by giantBlockSize at once
+		only the hashes of the probes are computed and the buckets are prefetched
 	*/
 	int64_t log(const G& xP) const
 	{
@@ -228,38 +717,176 @@ public:
 		if (ok) {
 			return c;
 		}
-		G posP = xP, negP = xP;
-		int64_t posCenter = 0;
-		int64_t negCenter = 0;
-		int64_t next = (int64_t)kcv_.size() * 2 + 1;
-		for (size_t i = 1; i < tryNum_; i++) {
-			I::add(posP, posP, nextNegP_);
-			posCenter += next;
-			c = basicLog(posP, &ok);
-			if (ok) {
-				return posCenter + c;
+		const int64_t next = (int64_t)hashSize_ * 2 + 1;
+		G Ps = xP; // xP - base nextP
+		I::normalize(Ps);
+		G Pa = Ps; // xP + base nextP
+		size_t base = 0;
+		uint32_t hSub[local::giantBlockSize], hAdd[local::giantBlockSize], hTmp[local::giantBlockSize];
+		bool isSpecial[local::giantBlockSize], isSpecialA[local::giantBlockSize];
+		std::vector<int> cv;
+		std::vector<size_t> idx;
+		std::vector<bool> isAdd;
+		const size_t tblSize = giantTbl_.size();
+		if (tblSize == 0) throw cybozu::Exception("HashTable:log:not found");
+		for (size_t i = 1; i < tryNum_;) {
+			if (i - base > tblSize) {
+				// shift the base points by the last giant step
+				const G& L = giantTbl_[tblSize - 1];
+				G N;
+				I::neg(N, L);
+				I::add(Ps, Ps, N);
+				I::add(Pa, Pa, L);
+				I::normalize(Ps);
+				I::normalize(Pa);
+				base += tblSize;
+			}
+			const size_t n = (std::min)(local::giantBlockSize, (std::min)(tryNum_ - i, base + tblSize + 1 - i));
+			const G *Q = &giantTbl_[i - base - 1];
+			if (base == 0) {
+				I::getHashSubAddVec(hSub, hAdd, isSpecial, Ps, Q, n);
+			} else {
+				I::getHashSubAddVec(hSub, hTmp, isSpecial, Ps, Q, n);
+				I::getHashSubAddVec(hTmp, hAdd, isSpecialA, Pa, Q, n);
+			}
+			for (size_t j = 0; j < n; j++) {
+				if (base > 0) isSpecial[j] = isSpecial[j] || isSpecialA[j];
+				if (isSpecial[j]) continue;
+				prefetchBucket(hSub[j]);
+				prefetchBucket(hAdd[j]);
 			}
-			I::add(negP, negP, nextP_);
-			negCenter -= next;
-			c = basicLog(negP, &ok);
-			if (ok) {
-				return negCenter + c;
+			cv.clear();
+			idx.clear();
+			isAdd.clear();
+			for (size_t j = 0; j < n; j++) {
+				const int64_t center = int64_t(i + j) * next;
+				if (isSpecial[j]) {
+					// xP -+ (i + j) nextP may be zero
+					G T;
+					I::neg(T, Q[j]);
+					I::add(T, Ps, T);
+					c = basicLog(T, &ok);
+					if (ok) return center + c;
+					I::add(T, Pa, Q[j]);
+					c = basicLog(T, &ok);
+					if (ok) return -center + c;
+					continue;
+				}
+				size_t m = cv.size();
+				appendCandidate(cv, hSub[j]);
+				for (; m < cv.size(); m++) {
+					idx.push_back(j);
+					isAdd.push_back(false);
+				}
+				appendCandidate(cv, hAdd[j]);
+				for (; m < cv.size(); m++) {
+					idx.push_back(j);
+					isAdd.push_back(true);
+				}
 			}
+			size_t k;
+			if (verify(k, c, Ps, Pa, Q, idx, isAdd, cv)) {
+				const int64_t center = int64_t(i + idx[k]) * next;
+				return isAdd[k] ? -center + c : center + c;
+			}
+			i += n;
 		}
 		throw cybozu::Exception("HashTable:log:not found");
 	}
+private:
+	/*
+		read the header up to the version
+		return the version or 0 for the old format
+		n = the size of KeyCount[] for the old format
+	*/
+	template<class InputStream>
+	static size_t loadVersion(InputStream& is, size_t& n)
+	{
+		int curveType;
+		cybozu::load(curveType, is);
+		if (curveType != bn_current::BN::param.curveType) throw cybozu::Exception("HashTable:bad curveType") << curveType;
+		char c = 0;
+		if (!cybozu::readChar(&c, is) || c != GtoChar<G>()) throw cybozu::Exception("HashTable:bad c") << (int)c;
+		size_t v;
+		cybozu::load(v, is);
+		if ((v & local::hashTableVersionMask) == 0) {
+			if (v >= 0x80000000u) throw cybozu::Exception("HashTable:bad size") << v;
+			n = v;
+			return 0;
+		}
+		v &= ~local::hashTableVersionMask;
+		if (v != local::hashTableVersion) throw cybozu::Exception("HashTable:bad version") << v;
+		return v;
+	}
+	template<class InputStream>
+	static void loadSize(InputStream& is, size_t& hashSize, size_t& bucketNum)
+	{
+		cybozu::load(hashSize, is);
+		cybozu::load(bucketNum, is);
+		if (hashSize >= 0x80000000u || bucketNum != (hashSize + local::bucketLoad - 1) / local::bucketLoad) {
+			throw cybozu::Exception("HashTable:bad size") << hashSize << bucketNum;
+		}
+	}
+	/*
+		read P_ and the padding
+	*/
+	template<class InputStream>
+	void loadP(InputStream& is)
+	{
+		P_.load(is);
+		char c = 0;
+		if (!cybozu::readChar(&c, is) || size_t(uint8_t(c)) >= local::cacheLineSize) throw cybozu::Exception("HashTable:bad padding") << (int)c;
+		char pad[local::cacheLineSize];
+		if (c) cybozu::read(pad, size_t(uint8_t(c)), is);
+	}
+	void initNextP()
+	{
+		I::mul(nextP_, P_, (hashSize_ * 2) + 1);
+		setWindowMethod();
+		initGiantTbl();
+	}
+	size_t loadView(const void *buf, size_t bufSize, local::MappedFile *map)
+	{
+		cybozu::MemoryInputStream is(buf, bufSize);
+		size_t n;
+		if (loadVersion(is, n) != local::hashTableVersion) throw cybozu::Exception("HashTable:loadView:bad version");
+		size_t hashSize, bucketNum;
+		loadSize(is, hashSize, bucketNum);
+		loadP(is);
+		const size_t pos = is.getPos();
+		const char *p = (const char*)buf + pos;
+		if (uintptr_t(p) % local::cacheLineSize) throw cybozu::Exception("HashTable:loadView:not aligned") << pos;
+		const size_t byteSize = sizeof(Bucket) * bucketNum;
+		if (bufSize - pos < byteSize) throw cybozu::Exception("HashTable:loadView:short") << bufSize << byteSize;
+		hashSize_ = hashSize;
+		tbl_.setView(reinterpret_cast<const Bucket*>(p), bucketNum, map);
+		initNextP();
+		return pos + byteSize;
+	}
+public:
 	/*
 		remark
 		tryNum is not saved.
+		the header, P, the padding and the buckets aligned to the cache line from the top
 	*/
 	template<class OutputStream>
 	void save(OutputStream& os) const
 	{
-		cybozu::save(os, bn_current::BN::param.curveType);
-		cybozu::writeChar(os, GtoChar<G>());
-		cybozu::save(os, kcv_.size());
-		cybozu::write(os, &kcv_[0], sizeof(kcv_[0]) * kcv_.size());
-		P_.save(os);
+		char hdr[local::maxHashTableHeaderSize];
+		cybozu::MemoryOutputStream hos(hdr, sizeof(hdr));
+		cybozu::save(hos, bn_current::BN::param.curveType);
+		cybozu::writeChar(hos, GtoChar<G>());
+		cybozu::save(hos, size_t(local::hashTableVersionMask | local::hashTableVersion));
+		cybozu::save(hos, hashSize_);
+		cybozu::save(hos, tbl_.size());
+		P_.save(hos);
+		const size_t hdrSize = hos.getPos();
+		const size_t padSize = (local::cacheLineSize - (hdrSize + 1) % local::cacheLineSize) % local::cacheLineSize;
+		const char pad[local::cacheLineSize] = {};
+		cybozu::write(os, hdr, hdrSize);
+		cybozu::writeChar(os, char(padSize));
+		if (padSize) cybozu::write(os, pad, padSize);
+		if (tbl_.size()) cybozu::write(os, tbl_.data(), sizeof(Bucket) * tbl_.size());
 	}
 	size_t save(void *buf, size_t maxBufSize) const
 	{
@@ -270,23 +897,29 @@ public:
 	/*
 		remark
 		tryNum is not set
+		the old format of sorted KeyCount[] is also accepted
 	*/
 	template<class InputStream>
 	void load(InputStream& is)
 	{
-		int curveType;
-		cybozu::load(curveType, is);
-		if (curveType != bn_current::BN::param.curveType) throw cybozu::Exception("HashTable:bad curveType") << curveType;
-		char c = 0;
-		if (!cybozu::readChar(&c, is) || c != GtoChar<G>()) throw cybozu::Exception("HashTable:bad c") << (int)c;
-		size_t kcvSize;
-		cybozu::load(kcvSize, is);
-		kcv_.resize(kcvSize);
-		cybozu::read(&kcv_[0], sizeof(kcv_[0]) * kcvSize, is);
-		P_.load(is);
-		I::mul(nextP_, P_, (kcvSize * 2) + 1);
-		I::neg(nextNegP_, nextP_);
-		setWindowMethod();
+		size_t n;
+		const size_t version = loadVersion(is, n);
+		if (version == 0) {
+			KeyCountVec kcv(n);
+			if (n > 0) cybozu::read(&kcv[0], sizeof(kcv[0]) * n, is);
+			initTbl(n);
+			for (size_t i = 0; i < n; i++) {
+				insert(kcv[i].key, kcv[i].count);
+			}
+			P_.load(is);
+		} else {
+			size_t hashSize, bucketNum;
+			loadSize(is, hashSize, bucketNum);
+			loadP(is);
+			initTbl(hashSize);
+			if (bucketNum) cybozu::read(tbl_.data(), sizeof(Bucket) * bucketNum, is);
+		}
+		initNextP();
 	}
 	size_t load(const void *buf, size_t bufSize)
 	{
@@ -294,6 +927,32 @@ public:
 		load(is);
 		return is.getPos();
 	}
+	/*
+		use the buckets in buf without copy
+		buf must be saved by save() and kept while the table is used
+		the buckets in buf must be aligned to the cache line
+		return the read size
+	*/
+	size_t loadView(const void *buf, size_t bufSize)
+	{
+		return loadView(buf, bufSize, 0);
+	}
+	/*
+		map the file saved by save() read-only and use it without copy
+		processes mapping the same file share it in the page cache
+	*/
+	void loadFile(const std::string& path)
+	{
+		local::MappedFile *map = new local::MappedFile();
+		try {
+			map->open(path);
+			loadView(map->get(), map->size(), map);
+		} catch (...) {
+			delete map;
+			throw;
+		}
+	}
+	bool isView() const { return tbl_.isView(); }
 	const mcl::fp::WindowMethod<I>& getWM() const { return wm_; }
 	/*
 		mul(x, P, y);
@@ -305,6 +964,283 @@ public:
 	}
 };
 
+/*
+	distinguished point of a tame kangaroo
+	pos is its log
+*/
+struct DistPoint {
+	uint32_t key;
+	uint32_t reserved;
+	int64_t pos;
+	bool operator<(const DistPoint& rhs) const
+	{
+		return key < rhs.key;
+	}
+};
+
+/*
+	Pollard's kangaroo method with the precomputed distinguished points of tame kangaroos
+	compute log_P(xP) for |x| < 2^(bitSize - 1) in O(sqrt(2^bitSize walkN / tblSize)) additions
+	ref. D. J. Bernstein and T. Lange, Computing small discrete logarithms faster
+	https://eprint.iacr.org/2012/458
+
+	a kangaroo at X jumps to X + jumpTbl_[hash(X) % jumpN] and
+	X is distinguished if the next dBits bits of hash(X) are zero
+	the positions are shifted by offset_ to be positive
+	walkN kangaroos jump at once to normalize them together
+*/
+template<class G, bool isEC = true>
+class KangarooTable {
+	typedef InterfaceForHashTable<G, isEC> I;
+	static const size_t jumpBit = 6;
+	static const size_t jumpN = size_t(1) << jumpBit;
+	static const size_t walkN = isEC ? 32 : 1;
+	static const size_t maxSegN = 64; // give up after walkN * maxSegN walks of each kangaroo
+	static const int maxLenCoeff = 8; // restart a kangaroo after maxLenCoeff * 2^dBits jumps
+	G P_;
+	size_t bitSize_;
+	size_t dBits_;
+	int64_t offset_;
+	G offsetP_; // offset_ P
+	std::vector<int64_t> jumpLen_;
+	std::vector<G> jumpTbl_;
+	std::vector<DistPoint> dpTbl_; // sorted by key
+	uint32_t dMask() const { return ((uint32_t(1) << dBits_) - 1) << jumpBit; }
+	// W/2 + W/32 for W = 2^bitSize
+	static int64_t getOffset(size_t bitSize)
+	{
+		return (int64_t(1) << (bitSize - 1)) + (int64_t(1) << (bitSize - 5));
+	}
+	static uint64_t getRand(cybozu::XorShift& rg, uint64_t n)
+	{
+		return rg.get64() % n;
+	}
+	void initJumpTbl()
+	{
+		jumpTbl_.resize(jumpN);
+		for (size_t i = 0; i < jumpN; i++) {
+			I::mul(jumpTbl_[i], P_, jumpLen_[i]);
+		}
+		I::normalizeVec(&jumpTbl_[0], &jumpTbl_[0], jumpN);
+		I::mul(offsetP_, P_, offset_);
+		I::normalize(offsetP_);
+	}
+	/*
+		X[i] += jumpTbl_[hash(X[i]) % jumpN], pos[i] += the jump
+	*/
+	void jump(G *X, int64_t *pos, const uint32_t *h, size_t n) const
+	{
+		for (size_t i = 0; i < n; i++) {
+			const size_t j = h[i] % jumpN;
+			I::add(X[i], X[i], jumpTbl_[j]);
+			pos[i] += jumpLen_[j];
+		}
+		I::normalizeVec(X, X, n);
+	}
+	void start(G& X, int64_t& pos, int& len, int64_t p) const
+	{
+		I::mul(X, P_, p);
+		I::normalize(X);
+		pos = p;
+		len = 0;
+	}
+public:
+	KangarooTable() : bitSize_(0), dBits_(0), offset_(0) {}
+	bool empty() const { return dpTbl_.empty(); }
+	void clear()
+	{
+		bitSize_ = 0;
+		dpTbl_.clear();
+	}
+	size_t getBitSize() const { return bitSize_; }
+	size_t getTblSize() const { return dpTbl_.size(); }
+	/*
+		collect at most tblSize distinguished points of tame kangaroos
+		5 <= bitSize <= 60
+		it takes about sqrt(2^bitSize tblSize / walkN) additions
+	*/
+	void init(const G& P, size_t bitSize, size_t tblSize)
+	{
+		if (bitSize < 5 || bitSize > 60) throw cybozu::Exception("KangarooTable:init:bad bitSize") << bitSize;
+		if (tblSize == 0 || tblSize >= 0x80000000u) throw cybozu::Exception("KangarooTable:init:bad tblSize") << tblSize;
+		P_ = P;
+		bitSize_ = bitSize;
+		const int64_t W = int64_t(1) << bitSize;
+		/*
+			each kangaroo of walkN ones should hit the tame paths of total length tblSize 2^dBits
+			with the probability 1/walkN in 2^dBits jumps
+		*/
+		const double d = std::sqrt(double(W) / (double(tblSize) * walkN));
+		dBits_ = d < 2 ? 0 : (std::min)(size_t(std::log(d) / std::log(2.0) + 0.5), size_t(32 - jumpBit));
+		// a path of 2^dBits jumps covers about W/64
+		const int64_t m = (std::max)(W >> (dBits_ + 6), int64_t(1));
+		const int64_t pad = W / 32;
+		offset_ = getOffset(bitSize);
+		cybozu::XorShift rg;
+		jumpLen_.resize(jumpN);
+		for (size_t i = 0; i < jumpN; i++) {
+			jumpLen_[i] = 1 + int64_t(getRand(rg, uint64_t(m) * 2 - 1));
+		}
+		initJumpTbl();
+		// the tame kangaroos start in [0, W + pad * 4)
+		const uint64_t startRange = uint64_t(W + pad * 4);
+		const int maxLen = maxLenCoeff << dBits_;
+		const uint32_t mask = dMask();
+		std::vector<DistPoint> dpv;
+		dpv.reserve(tblSize);
+		G X[walkN];
+		int64_t pos[walkN];
+		int len[walkN];
+		uint32_t h[walkN];
+		for (size_t i = 0; i < walkN; i++) {
+			start(X[i], pos[i], len[i], int64_t(getRand(rg, startRange)));
+		}
+		while (dpv.size() < tblSize) {
+			for (size_t i = 0; i < walkN; i++) {
+				h[i] = I::getHash(X[i]);
+				if ((h[i] & mask) == 0 && dpv.size() < tblSize) {
+					DistPoint dp;
+					dp.key = h[i];
+					dp.reserved = 0;
+					dp.pos = pos[i];
+					dpv.push_back(dp);
+					start(X[i], pos[i], len[i], int64_t(getRand(rg, startRange)));
+					h[i] = I::getHash(X[i]);
+				} else if (++len[i] > maxLen) {
+					start(X[i], pos[i], len[i], int64_t(getRand(rg, startRange)));
+					h[i] = I::getHash(X[i]);
+				}
+			}
+			jump(X, pos, h, walkN);
+		}
+		// the merged paths give the same point
+		std::sort(dpv.begin(), dpv.end(), lessKeyPos);
+		dpv.erase(std::unique(dpv.begin(), dpv.end(), isSameKeyPos), dpv.end());
+		dpTbl_.swap(dpv);
+	}
+	/*
+		compute log_P(xP) for |x| < 2^(bitSize - 1)
+		throw if not found after walkN * maxSegN walks of each kangaroo
+	*/
+	int64_t log(const G& xP) const
+	{
+		if (empty()) throw cybozu::Exception("KangarooTable:log:not initialized");
+		if (I::isZero(xP)) return 0;
+		G Q; // (x + offset_) P
+		I::add(Q, xP, offsetP_);
+		if (I::isZero(Q)) return -offset_;
+		I::normalize(Q);
+		const int64_t W = int64_t(1) << bitSize_;
+		const uint64_t startRange = uint64_t((std::max)(W / 8, int64_t(1)));
+		const int maxLen = maxLenCoeff << dBits_;
+		const uint32_t mask = dMask();
+		cybozu::XorShift rg(I::getHash(Q));
+		G X[walkN];
+		int64_t pos[walkN]; // X[i] = Q + pos[i] P
+		int len[walkN];
+		uint32_t h[walkN];
+		G T;
+		/*
+			the wild kangaroos start at Q + r P for random r in [0, W/8)
+			a narrower range makes the restarted walks merge too early for small W
+		*/
+		for (size_t i = 0; i < walkN; i++) {
+			start(X[i], pos[i], len[i], int64_t(getRand(rg, startRange)));
+			I::add(X[i], X[i], Q);
+		}
+		I::normalizeVec(X, X, walkN);
+		size_t segN = 0;
+		for (;;) {
+			for (size_t i = 0; i < walkN; i++) {
+				h[i] = I::getHash(X[i]);
+				bool restart = false;
+				if ((h[i] & mask) == 0) {
+					DistPoint dp;
+					dp.key = h[i];
+					typedef std::vector<DistPoint>::const_iterator Iter;
+					std::pair<Iter, Iter> r = std::equal_range(dpTbl_.begin(), dpTbl_.end(), dp);
+					for (Iter j = r.first; j != r.second; ++j) {
+						const int64_t x = j->pos - pos[i] - offset_;
+						I::mul(T, P_, x);
+						if (T == xP) return x;
+					}
+					restart = true;
+				} else if (++len[i] > maxLen) {
+					restart = true;
+				}
+				if (restart) {
+					if (++segN > walkN * maxSegN) throw cybozu::Exception("KangarooTable:log:not found");
+					start(X[i], pos[i], len[i], int64_t(getRand(rg, startRange)));
+					I::add(X[i], X[i], Q);
+					I::normalize(X[i]);
+					h[i] = I::getHash(X[i]);
+				}
+			}
+			jump(X, pos, h, walkN);
+		}
+	}
+	template<class OutputStream>
+	void save(OutputStream& os) const
+	{
+		cybozu::save(os, bn_current::BN::param.curveType);
+		cybozu::writeChar(os, GtoChar<G>());
+		cybozu::save(os, bitSize_);
+		cybozu::save(os, dBits_);
+		cybozu::write(os, &jumpLen_[0], sizeof(jumpLen_[0]) * jumpN);
+		cybozu::save(os, dpTbl_.size());
+		if (!dpTbl_.empty()) cybozu::write(os, &dpTbl_[0], sizeof(dpTbl_[0]) * dpTbl_.size());
+		P_.save(os);
+	}
+	size_t save(void *buf, size_t maxBufSize) const
+	{
+		cybozu::MemoryOutputStream os(buf, maxBufSize);
+		save(os);
+		return os.getPos();
+	}
+	template<class InputStream>
+	void load(InputStream& is)
+	{
+		int curveType;
+		cybozu::load(curveType, is);
+		if (curveType != bn_current::BN::param.curveType) throw cybozu::Exception("KangarooTable:bad curveType") << curveType;
+		char c = 0;
+		if (!cybozu::readChar(&c, is) || c != GtoChar<G>()) throw cybozu::Exception("KangarooTable:bad c") << (int)c;
+		size_t bitSize, dBits, n;
+		cybozu::load(bitSize, is);
+		cybozu::load(dBits, is);
+		if (bitSize < 5 || bitSize > 60 || dBits > 32 - jumpBit) throw cybozu::Exception("KangarooTable:bad size") << bitSize << dBits;
+		std::vector<int64_t> jumpLen(jumpN);
+		cybozu::read(&jumpLen[0], sizeof(jumpLen[0]) * jumpN, is);
+		cybozu::load(n, is);
+		if (n >= 0x80000000u) throw cybozu::Exception("KangarooTable:bad size") << n;
+		std::vector<DistPoint> dpv(n);
+		if (n) cybozu::read(&dpv[0], sizeof(dpv[0]) * n, is);
+		P_.load(is);
+		bitSize_ = bitSize;
+		dBits_ = dBits;
+		offset_ = getOffset(bitSize);
+		jumpLen_.swap(jumpLen);
+		std::sort(dpv.begin(), dpv.end(), lessKeyPos);
+		dpTbl_.swap(dpv);
+		initJumpTbl();
+	}
+	size_t load(const void *buf, size_t bufSize)
+	{
+		cybozu::MemoryInputStream is(buf, bufSize);
+		load(is);
+		return is.getPos();
+	}
+private:
+	static bool lessKeyPos(const DistPoint& x, const DistPoint& y)
+	{
+		return x.key < y.key || (x.key == y.key && x.pos < y.pos);
+	}
+	static bool isSameKeyPos(const DistPoint& x, const DistPoint& y)
+	{
+		return x.key == y.key && x.pos == y.pos;
+	}
+};
+
 template<class G>
 int log(const G& P, const G& xP)
 {
@@ -348,6 +1284,9 @@ struct SHET {
 	static mcl::fp::WindowMethod<G2> Qwm_;
 	typedef local::InterfaceForHashTable<GT, false> GTasEC;
 	static local::HashTable<GT, false> ePQhashTbl_;
+	static local::KangarooTable<G1> PkangarooTbl_;
+	static local::KangarooTable<G2> QkangarooTbl_;
+	static local::KangarooTable<GT, false> ePQkangarooTbl_;
 	static bool useDecG1ViaGT_;
 	static bool useDecG2ViaGT_;
 private:
@@ -401,6 +1340,70 @@ private:
 			G::neg(y.S_, x.S_);
 			G::neg(y.T_, x.T_);
 		}
+		/*
+			z = sum_{i=0}^{n-1} w[i] x[i] by Pippenger's method over S and T
+			the weights are short so the GLV split is not used and
+			the number of windows depends on the max bit length of |w[i]|
+		*/
+		static void linearCombinationBase(CipherTextAT& z, const CipherTextAT *x, const int64_t *w, size_t n)
+		{
+			if (n == 0) {
+				z.clear();
+				return;
+			}
+			const size_t yn = (64 + fp::UnitBitSize - 1) / fp::UnitBitSize;
+			std::vector<G> S(n), T(n);
+			std::vector<fp::Unit> y(n * yn);
+			for (size_t i = 0; i < n; i++) {
+				S[i] = x[i].S_;
+				T[i] = x[i].T_;
+			}
+			G::normalizeVec(&S[0], &S[0], n);
+			G::normalizeVec(&T[0], &T[0], n);
+			for (size_t i = 0; i < n; i++) {
+				uint64_t u = uint64_t(w[i]);
+				if (w[i] < 0) {
+					u = uint64_t(0) - u;
+					G::neg(S[i], S[i]);
+					G::neg(T[i], T[i]);
+				}
+				for (size_t j = 0; j < yn; j++) {
+					y[i * yn + j] = fp::Unit(u >> (j * fp::UnitBitSize));
+				}
+			}
+			G::mulVecArrayBase(z.S_, &S[0], &y[0], yn, n);
+			G::mulVecArrayBase(z.T_, &T[0], &y[0], yn, n);
+		}
+		/*
+			z = sum_{i=0}^{n-1} w[i] x[i]
+			split x[0, n) into cpuN ranges computed with OpenMP (MCL_USE_OMP=1)
+			use omp_get_max_threads() if cpuN = 0
+		*/
+		static void linearCombination(CipherTextAT& z, const CipherTextAT *x, const int64_t *w, size_t n, size_t cpuN = 0)
+		{
+#ifdef MCL_USE_OMP
+			const size_t minN = 64; // the least number of ciphertexts per thread
+			if (cpuN == 0) cpuN = omp_get_max_threads();
+			if (cpuN > n / minN) cpuN = n / minN;
+			if (cpuN > 1) {
+				std::vector<CipherTextAT> partial(cpuN);
+				#pragma omp parallel for num_threads(int(cpuN))
+				for (int i = 0; i < int(cpuN); i++) {
+					const size_t begin = n * i / cpuN;
+					const size_t end = n * (i + 1) / cpuN;
+					linearCombinationBase(partial[i], x + begin, w + begin, end - begin);
+				}
+				for (size_t i = 1; i < cpuN; i++) {
+					add(partial[0], partial[0], partial[i]);
+				}
+				z = partial[0];
+				return;
+			}
+#else
+			(void)cpuN;
+#endif
+			linearCombinationBase(z, x, w, n);
+		}
 		void add(const CipherTextAT& c) { add(*this, *this, c); }
 		void sub(const CipherTextAT& c) { sub(*this, *this, c); }
 		template<class InputStream>
@@ -471,6 +1474,32 @@ private:
 		tensorProductML(g,S1, T1, S2,T2);
 		finalExp4(g, g);
 	}
+	/*
+		log by the hash table
+		fall back to the kangaroo table if it is set and the hash table fails
+	*/
+	template<class HashTable, class KangarooTable, class G>
+	static int64_t logT(const HashTable& hashTbl, const KangarooTable& kangarooTbl, const G& R)
+	{
+		if (kangarooTbl.empty()) return hashTbl.log(R);
+		try {
+			return hashTbl.log(R);
+		} catch (std::exception&) {
+			return kangarooTbl.log(R);
+		}
+	}
+	template<class KangarooTable, class G>
+	static void setKangarooRange(KangarooTable& tbl, const G& P, size_t bitSize, size_t tblSize)
+	{
+		if (bitSize == 0) {
+			tbl.clear();
+		} else {
+			tbl.init(P, bitSize, tblSize);
+		}
+	}
+	static int64_t logG1(const G1& R) { return logT(PhashTbl_, PkangarooTbl_, R); }
+	static int64_t logG2(const G2& R) { return logT(QhashTbl_, QkangarooTbl_, R); }
+	static int64_t logGT(const GT& R) { return logT(ePQhashTbl_, ePQkangarooTbl_, R); }
 public:
 	struct ZkpBin : public fp::Serializable<ZkpBin> {
 		Fr d_[4];
@@ -546,6 +1575,24 @@ public:
 		setRangeForG2DLP(hashSize);
 		setRangeForGTDLP(hashSize);
 	}
+	/*
+		decode m for |m| < 2^(bitSize - 1) by the kangaroo method if the hash table fails
+		the table has at most tblSize distinguished points (16 bytes each)
+		decode time = O(sqrt(2^bitSize / tblSize)), init time = O(sqrt(2^bitSize tblSize))
+		clear the kangaroo table if bitSize = 0
+	*/
+	static void setKangarooRangeForG1DLP(size_t bitSize, size_t tblSize = local::defaultKangarooTblSize)
+	{
+		setKangarooRange(PkangarooTbl_, P_, bitSize, tblSize);
+	}
+	static void setKangarooRangeForG2DLP(size_t bitSize, size_t tblSize = local::defaultKangarooTblSize)
+	{
+		setKangarooRange(QkangarooTbl_, Q_, bitSize, tblSize);
+	}
+	static void setKangarooRangeForGTDLP(size_t bitSize, size_t tblSize = local::defaultKangarooTblSize)
+	{
+		setKangarooRange(ePQkangarooTbl_, ePQ_, bitSize, tblSize);
+	}
 	static void setTryNum(size_t tryNum)
 	{
 		PhashTbl_.setTryNum(tryNum);
@@ -583,6 +1630,89 @@ public:
 			v *= u;
 			v *= c.g_[0];
 		}
+		/*
+			m[i] = log(S[i] - x T[i]) for i in [0, n)
+			normalize S[i] - x T[i] at once by normalizeBlockSize
+		*/
+		template<class G>
+		static void decRangeAT(int64_t *m, bool *ok, const CipherTextAT<G> *c, size_t n, const Fr& x, int64_t log(const G&))
+		{
+			std::vector<G> R((std::min)(n, local::normalizeBlockSize));
+			for (size_t i = 0; i < n; i += R.size()) {
+				const size_t k = (std::min)(R.size(), n - i);
+				for (size_t j = 0; j < k; j++) {
+					G::mul(R[j], c[i + j].T_, x);
+					G::sub(R[j], c[i + j].S_, R[j]);
+				}
+				G::normalizeVec(&R[0], &R[0], k);
+				for (size_t j = 0; j < k; j++) {
+					try {
+						m[i + j] = log(R[j]);
+						ok[i + j] = true;
+					} catch (std::exception&) {
+						m[i + j] = 0;
+						ok[i + j] = false;
+					}
+				}
+			}
+		}
+		template<class CT>
+		void decRange(int64_t *m, bool *ok, const CT *c, size_t n) const
+		{
+			for (size_t i = 0; i < n; i++) {
+				try {
+					m[i] = dec(c[i]);
+					ok[i] = true;
+				} catch (std::exception&) {
+					m[i] = 0;
+					ok[i] = false;
+				}
+			}
+		}
+		void decRange(int64_t *m, bool *ok, const CipherTextG1 *c, size_t n) const
+		{
+			if (useDecG1ViaGT_) {
+				decRange<CipherTextG1>(m, ok, c, n);
+			} else {
+				decRangeAT(m, ok, c, n, x_, logG1);
+			}
+		}
+		void decRange(int64_t *m, bool *ok, const CipherTextG2 *c, size_t n) const
+		{
+			if (useDecG2ViaGT_) {
+				decRange<CipherTextG2>(m, ok, c, n);
+			} else {
+				decRangeAT(m, ok, c, n, y_, logG2);
+			}
+		}
+		static bool isAllOk(const bool *ok, size_t n)
+		{
+			for (size_t i = 0; i < n; i++) {
+				if (!ok[i]) return false;
+			}
+			return true;
+		}
+		template<class CT>
+		bool decVecT(int64_t *m, bool *ok, const CT *c, size_t n, size_t cpuN) const
+		{
+#ifdef MCL_USE_OMP
+			if (cpuN == 0) cpuN = omp_get_max_threads();
+			if (cpuN > n) cpuN = n;
+			if (cpuN > 1) {
+				#pragma omp parallel for num_threads(int(cpuN))
+				for (int i = 0; i < int(cpuN); i++) {
+					const size_t begin = n * i / cpuN;
+					const size_t end = n * (i + 1) / cpuN;
+					decRange(m + begin, ok + begin, c + begin, end - begin);
+				}
+				return isAllOk(ok, n);
+			}
+#else
+			(void)cpuN;
+#endif
+			decRange(m, ok, c, n);
+			return isAllOk(ok, n);
+		}
 	public:
 		void setByCSPRNG()
 		{
@@ -626,7 +1756,7 @@ public:
 			G1 R;
 			G1::mul(R, c.T_, x_);
 			G1::sub(R, c.S_, R);
-			return PhashTbl_.log(R);
+			return logG1(R);
 		}
 		int64_t dec(const CipherTextG2& c) const
 		{
@@ -634,7 +1764,7 @@ public:
 			G2 R;
 			G2::mul(R, c.T_, y_);
 			G2::sub(R, c.S_, R);
-			return QhashTbl_.log(R);
+			return logG2(R);
 		}
 		int64_t dec(const CipherTextA& c) const
 		{
@@ -644,7 +1774,7 @@ public:
 		{
 			GT v;
 			getPowOfePQ(v, c);
-			return ePQhashTbl_.log(v);
+			return logGT(v);
 //			return log(g, v);
 		}
 		int64_t decViaGT(const CipherTextG1& c) const
@@ -654,7 +1784,7 @@ public:
 			G1::sub(R, c.S_, R);
 			GT v;
 			BN::pairing(v, R, Q_);
-			return ePQhashTbl_.log(v);
+			return logGT(v);
 		}
 		int64_t decViaGT(const CipherTextG2& c) const
 		{
@@ -663,7 +1793,7 @@ public:
 			G2::sub(R, c.S_, R);
 			GT v;
 			BN::pairing(v, P_, R);
-			return ePQhashTbl_.log(v);
+			return logGT(v);
 		}
 		int64_t dec(const CipherText& c) const
 		{
@@ -673,6 +1803,29 @@ public:
 				return dec(c.a_);
 			}
 		}
+		/*
+			m[i] = dec(c[i]) for i in [0, n)
+			ok[i] = false and m[i] = 0 if c[i] can not be decrypted
+			split c[] into cpuN ranges decrypted with OpenMP (MCL_USE_OMP=1)
+			use omp_get_max_threads() if cpuN = 0
+			return true if all of c[] are decrypted
+		*/
+		bool decVec(int64_t *m, bool *ok, const CipherTextG1 *c, size_t n, size_t cpuN = 0) const
+		{
+			return decVecT(m, ok, c, n, cpuN);
+		}
+		bool decVec(int64_t *m, bool *ok, const CipherTextG2 *c, size_t n, size_t cpuN = 0) const
+		{
+			return decVecT(m, ok, c, n, cpuN);
+		}
+		bool decVec(int64_t *m, bool *ok, const CipherTextGT *c, size_t n, size_t cpuN = 0) const
+		{
+			return decVecT(m, ok, c, n, cpuN);
+		}
+		bool decVec(int64_t *m, bool *ok, const CipherText *c, size_t n, size_t cpuN = 0) const
+		{
+			return decVecT(m, ok, c, n, cpuN);
+		}
 		bool isZero(const CipherTextG1& c) const
 		{
 			return c.isZero(x_);
@@ -1085,7 +2238,9 @@ public:
 	class PrecomputedPublicKey : public fp::Serializable<PrecomputedPublicKey,
 		PublicKeyMethod<PrecomputedPublicKey> > {
 		typedef local::InterfaceForHashTable<GT, false> GTasEC;
-		typedef mcl::fp::WindowMethod<GTasEC> GTwin;
+		typedef mcl::bn::GLV1<bn_current::Fp> GLV1;
+		typedef mcl::bn::GLV2<bn_current::Fp2> GLV2;
+		typedef mcl::bn::FixedBaseGLV<GTasEC, GLV2, 4> GTwin;
 		template<class T>
 		friend struct PublicKeyMethod;
 		GT exPQ_;
@@ -1094,8 +2249,8 @@ public:
 		GTwin exPQwm_;
 		GTwin eyPQwm_;
 		GTwin exyPQwm_;
-		mcl::fp::WindowMethod<G1> xPwm_;
-		mcl::fp::WindowMethod<G2> yQwm_;
+		mcl::bn::FixedBaseGLV<G1, GLV1, 2> xPwm_;
+		mcl::bn::FixedBaseGLV<G2, GLV2, 4> yQwm_;
 		template<class T>
 		void mulByWindowMethod(GT& x, const GTwin& wm, const T& y) const
 		{
@@ -1132,17 +2287,27 @@ public:
 			ePQhashTbl_.mulByWindowMethod(c.g_[3], rb);
 		}
 	public:
-		void init(const PublicKey& pub)
+		/*
+			winSize : time/memory tradeoff of the fixed-base tables
+			each table has about (r.bitSize / splitN / winSize) 2^(winSize - 1) elements
+		*/
+		void init(const PublicKey& pub, size_t winSize = local::fixedBaseWinSize)
 		{
 			BN::pairing(exPQ_, pub.xP_, Q_);
 			BN::pairing(eyPQ_, P_, pub.yQ_);
 			BN::pairing(exyPQ_, pub.xP_, pub.yQ_);
-			const size_t bitSize = Fr::getBitSize();
-			exPQwm_.init(static_cast<const GTasEC&>(exPQ_), bitSize, local::winSize);
-			eyPQwm_.init(static_cast<const GTasEC&>(eyPQ_), bitSize, local::winSize);
-			exyPQwm_.init(static_cast<const GTasEC&>(exyPQ_), bitSize, local::winSize);
-			xPwm_.init(pub.xP_, bitSize, local::winSize);
-			yQwm_.init(pub.yQ_, bitSize, local::winSize);
+			const GLV1& glv1 = BN::param.glv1;
+			const GLV2& glv2 = BN::param.glv2;
+			exPQwm_.init(static_cast<const GTasEC&>(exPQ_), glv2, winSize);
+			eyPQwm_.init(static_cast<const GTasEC&>(eyPQ_), glv2, winSize);
+			exyPQwm_.init(static_cast<const GTasEC&>(exyPQ_), glv2, winSize);
+			xPwm_.init(pub.xP_, glv1, winSize);
+			yQwm_.init(pub.yQ_, glv2, winSize);
+		}
+		size_t getTblByteSize() const
+		{
+			return exPQwm_.getTblByteSize() + eyPQwm_.getTblByteSize() + exyPQwm_.getTblByteSize()
+				+ xPwm_.getTblByteSize() + yQwm_.getTblByteSize();
 		}
 		void encWithZkpBin(CipherTextG1& c, ZkpBin& zkp, int m) const
 		{
@@ -1296,6 +2461,73 @@ public:
 		{
 			mul(z, x.c1_, y.c2_);
 		}
+		/*
+			z = mulML(x[0], y[0]) + ... + mulML(x[n-1], y[n-1])
+			the lines of S and T of y[i] are precomputed by innerProductBlockSize
+			and used for both S and T of x[i]
+			the squarings of each of the four Miller loops are shared by all the pairs
+		*/
+		static void innerProductML(CipherTextGT& z, const CipherTextG1 *x, const CipherTextG2 *y, size_t n)
+		{
+			z.clear();
+			if (n == 0) return;
+			const size_t QcoeffSize = BN::param.precomputedQcoeffSize;
+			const size_t blockSize = (std::min)(n, local::innerProductBlockSize);
+			std::vector<G1> S1(blockSize), T1(blockSize);
+			std::vector<bn_current::Fp6> S2coeff(blockSize * QcoeffSize), T2coeff(blockSize * QcoeffSize);
+			GT f;
+			for (size_t i = 0; i < n; i += blockSize) {
+				const size_t k = (std::min)(blockSize, n - i);
+				for (size_t j = 0; j < k; j++) {
+					S1[j] = x[i + j].S_;
+					T1[j] = x[i + j].T_;
+					BN::precomputeG2(&S2coeff[j * QcoeffSize], y[i + j].S_);
+					BN::precomputeG2(&T2coeff[j * QcoeffSize], y[i + j].T_);
+				}
+				/*
+					(S1, T1) * (S2, T2) = (ML(S1, S2), ML(S1, T2), ML(T1, S2), ML(T1, T2))
+				*/
+				BN::precomputedMillerLoopVec(f, &S1[0], &S2coeff[0], k);
+				z.g_[0] *= f;
+				BN::precomputedMillerLoopVec(f, &S1[0], &T2coeff[0], k);
+				z.g_[1] *= f;
+				BN::precomputedMillerLoopVec(f, &T1[0], &S2coeff[0], k);
+				z.g_[2] *= f;
+				BN::precomputedMillerLoopVec(f, &T1[0], &T2coeff[0], k);
+				z.g_[3] *= f;
+			}
+		}
+		/*
+			z = mul(x[0], y[0]) + ... + mul(x[n-1], y[n-1]) by one finalExp
+			split the pairs into cpuN ranges computed with OpenMP (MCL_USE_OMP=1)
+			use omp_get_max_threads() if cpuN = 0
+		*/
+		static void innerProduct(CipherTextGT& z, const CipherTextG1 *x, const CipherTextG2 *y, size_t n, size_t cpuN = 0)
+		{
+#ifdef MCL_USE_OMP
+			const size_t minN = 4; // the least number of pairs per thread
+			if (cpuN == 0) cpuN = omp_get_max_threads();
+			if (cpuN > n / minN) cpuN = n / minN;
+			if (cpuN > 1) {
+				std::vector<CipherTextGT> partial(cpuN);
+				#pragma omp parallel for num_threads(int(cpuN))
+				for (int i = 0; i < int(cpuN); i++) {
+					const size_t begin = n * i / cpuN;
+					const size_t end = n * (i + 1) / cpuN;
+					innerProductML(partial[i], x + begin, y + begin, end - begin);
+				}
+				for (size_t i = 1; i < cpuN; i++) {
+					add(partial[0], partial[0], partial[i]);
+				}
+				finalExp(z, partial[0]);
+				return;
+			}
+#else
+			(void)cpuN;
+#endif
+			innerProductML(z, x, y, n);
+			finalExp(z, z);
+		}
 		static void mul(CipherTextGT& z, const CipherTextGT& x, int64_t y)
 		{
 			for (int i = 0; i < 4; i++) {
@@ -1458,6 +2690,9 @@ template<class BN, class Fr> std::vector<bn_current::Fp6> SHET<BN, Fr>::Qcoeff_;
 template<class BN, class Fr> local::HashTable<typename BN::G1> SHET<BN, Fr>::PhashTbl_;
 template<class BN, class Fr> local::HashTable<typename BN::G2> SHET<BN, Fr>::QhashTbl_;
 template<class BN, class Fr> local::HashTable<typename BN::Fp12, false> SHET<BN, Fr>::ePQhashTbl_;
+template<class BN, class Fr> local::KangarooTable<typename BN::G1> SHET<BN, Fr>::PkangarooTbl_;
+template<class BN, class Fr> local::KangarooTable<typename BN::G2> SHET<BN, Fr>::QkangarooTbl_;
+template<class BN, class Fr> local::KangarooTable<typename BN::Fp12, false> SHET<BN, Fr>::ePQkangarooTbl_;
 template<class BN, class Fr> bool SHET<BN, Fr>::useDecG1ViaGT_;
 template<class BN, class Fr> bool SHET<BN, Fr>::useDecG2ViaGT_;
 typedef mcl::she::SHET<bn_current::BN, bn_current::Fr> SHE;
@@ -7,6 +7,7 @@
 	http://opensource.org/licenses/BSD-3-Clause
 */
 #include <cybozu/bit_operation.hpp>
+#include <vector>
 
 #ifdef _MSC_VER
 	#pragma warning(push)
@@ -146,6 +147,57 @@ size_t getNonZeroArraySize(const T *x, size_t n)
 	return 1;
 }
 
+/*
+	get the Unit from bitPos of x[0, xn)
+	x[] is treated as zero beyond xn
+*/
+template<class T>
+T getUnitAt(const T *x, size_t xn, size_t bitPos)
+{
+	const size_t TbitSize = sizeof(T) * 8;
+	const size_t q = bitPos / TbitSize;
+	const size_t r = bitPos % TbitSize;
+	if (q >= xn) return 0;
+	if (r == 0 || q + 1 == xn) return x[q] >> r;
+	return (x[q] >> r) | (x[q + 1] << (TbitSize - r));
+}
+
+/*
+	width-w NAF of x[0, xn) from the bottom
+	x = sum_i naf[i] 2^i
+	naf[i] is 0 or odd and |naf[i]| < 2^(w-1)
+	naf is empty if x = 0 else the top of naf is not zero
+	assume 2 <= w <= 8
+*/
+template<class Vec, class T>
+void getNAFwidth(Vec& naf, const T *x, size_t xn, size_t w)
+{
+	assert(2 <= w && w <= 8);
+	xn = getNonZeroArraySize(x, xn);
+	const size_t TbitSize = sizeof(T) * 8;
+	// one more bit for the last carry
+	const size_t len = x[xn - 1] ? (xn - 1) * TbitSize + cybozu::bsr<T>(x[xn - 1]) + 2 : 0;
+	naf.clear();
+	naf.resize(len);
+	int carry = 0;
+	size_t pos = 0;
+	while (pos < len) {
+		if (int(getUnitAt(x, xn, pos) & 1) == carry) {
+			pos++;
+			continue;
+		}
+		size_t n = w;
+		if (n > len - pos) n = len - pos;
+		int v = int(getUnitAt(x, xn, pos) & ((T(1) << n) - 1)) + carry;
+		carry = (v >> (w - 1)) & 1;
+		v -= carry << w;
+		naf[pos] = v;
+		pos += n;
+	}
+	assert(carry == 0);
+	while (!naf.empty() && naf.back() == 0) naf.pop_back();
+}
+
 /*
 	@param out [inout] : set element of G ; out = x^y[]
 	@param x [in]
@@ -259,6 +311,46 @@ bool mulSmallUnit(T& z, const T& x, U y)
 	return true;
 }
 
+/*
+	Montgomery's trick
+	y[i] = 1 / x[i] for i in [0, n) by one inv and 3(n - 1) mul
+	y[i] = 0 if x[i] = 0
+	y may be equal to x
+*/
+template<class T>
+void invVec(T *y, const T *x, size_t n)
+{
+	std::vector<T> tmp(n);
+	size_t pos = n; // the first non-zero element
+	T t;
+	for (size_t i = 0; i < n; i++) {
+		if (x[i].isZero()) continue;
+		if (pos == n) {
+			pos = i;
+			t = x[i];
+			continue;
+		}
+		tmp[i] = t; // x[pos] * ... * x[i - 1]
+		T::mul(t, t, x[i]);
+	}
+	if (pos == n) {
+		for (size_t i = 0; i < n; i++) y[i].clear();
+		return;
+	}
+	T::inv(t, t);
+	for (size_t i = n - 1; i > pos; i--) {
+		if (x[i].isZero()) {
+			y[i].clear();
+			continue;
+		}
+		T::mul(tmp[i], tmp[i], t);
+		T::mul(t, t, x[i]);
+		y[i] = tmp[i];
+	}
+	y[pos] = t;
+	for (size_t i = 0; i < pos; i++) y[i].clear();
+}
+
 } } // mcl::fp
 
 #ifdef _MSC_VER
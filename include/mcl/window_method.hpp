@@ -105,9 +105,7 @@ public:
 				}
 				Ec::dbl(t, t);
 			}
-			for (size_t j = 0; j < w.size(); j++) {
-				w[j].normalize();
-			}
+			Ec::normalizeVec(&w[0], &w[0], r);
 		}
 	}
 	/*
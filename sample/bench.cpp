@@ -4,6 +4,7 @@
 #include <mcl/fp.hpp>
 #include "../src/conversion.hpp"
 #include <mcl/ecparam.hpp>
+#include <mcl/bn256.hpp>
 
 typedef mcl::FpT<> Fp;
 typedef mcl::FpT<mcl::ZnTag> Zn;
@@ -179,6 +180,141 @@ void benchFromStr16()
 	}
 }
 
+template<class G, class F>
+void mulSum(G& z, const G *x, const F *y, size_t n)
+{
+	G t;
+	z.clear();
+	for (size_t i = 0; i < n; i++) {
+		G::mul(t, x[i], y[i]);
+		z += t;
+	}
+}
+
+/*
+	G1::mulVec and G2::mulVec for n = 2^4, ..., 2^maxLogN
+	compared with n times of mul for small n
+*/
+void benchMulVec(size_t maxLogN)
+{
+	using namespace mcl::bn256;
+	puts("benchMulVec");
+	initPairing();
+	const size_t maxN = size_t(1) << maxLogN;
+	std::vector<G1> Pv(maxN);
+	std::vector<G2> Qv(maxN);
+	std::vector<Fr> yv(maxN);
+	cybozu::XorShift rg;
+	G1 P;
+	G2 Q;
+	BN::hashAndMapToG1(P, "abc", 3);
+	BN::hashAndMapToG2(Q, "abc", 3);
+	for (size_t i = 0; i < maxN; i++) {
+		Fr t;
+		t.setRand(rg);
+		G1::mul(Pv[i], P, t);
+		G2::mul(Qv[i], Q, t);
+		yv[i].setRand(rg);
+	}
+	G1::normalizeVec(&Pv[0], &Pv[0], maxN);
+	G2::normalizeVec(&Qv[0], &Qv[0], maxN);
+	for (size_t logN = 4; logN <= maxLogN; logN++) {
+		const size_t n = size_t(1) << logN;
+		const int C = int(std::max<size_t>(1, 1024 / n));
+		G1 PP;
+		G2 QQ;
+		printf("n=%d\n", (int)n);
+		CYBOZU_BENCH_C("G1::mulVec", C, G1::mulVec, PP, &Pv[0], &yv[0], n);
+		CYBOZU_BENCH_C("G2::mulVec", C, G2::mulVec, QQ, &Qv[0], &yv[0], n);
+		if (logN > 10) continue;
+		CYBOZU_BENCH_C("G1::mul*n ", C, mulSum, PP, &Pv[0], &yv[0], n);
+		CYBOZU_BENCH_C("G2::mul*n ", C, mulSum, QQ, &Qv[0], &yv[0], n);
+	}
+}
+
+/*
+	G1::mulVecMT and G2::mulVecMT for n = 2^logN
+	report the speedup for the number of threads = 1, 2, 4, ..., maxThreadN
+*/
+void benchMulVecMT(size_t logN, size_t maxThreadN)
+{
+	using namespace mcl::bn256;
+	puts("benchMulVecMT");
+#ifndef MCL_USE_OMP
+	puts("MCL_USE_OMP is not defined, then mulVecMT runs in a single thread");
+#endif
+	initPairing();
+	const size_t n = size_t(1) << logN;
+	std::vector<G1> Pv(n);
+	std::vector<G2> Qv(n);
+	std::vector<Fr> yv(n);
+	cybozu::XorShift rg;
+	G1 P;
+	G2 Q;
+	BN::hashAndMapToG1(P, "abc", 3);
+	BN::hashAndMapToG2(Q, "abc", 3);
+	for (size_t i = 0; i < n; i++) {
+		Fr t;
+		t.setRand(rg);
+		G1::mul(Pv[i], P, t);
+		G2::mul(Qv[i], Q, t);
+		yv[i].setRand(rg);
+	}
+	G1::normalizeVec(&Pv[0], &Pv[0], n);
+	G2::normalizeVec(&Qv[0], &Qv[0], n);
+	G1 PP;
+	G2 QQ;
+	double t1G1 = 0, t1G2 = 0;
+	printf("n=%d\n", (int)n);
+	for (size_t threadN = 1; threadN <= maxThreadN; threadN *= 2) {
+		double tG1, tG2;
+		CYBOZU_BENCH_T(tG1, G1::mulVecMT, PP, &Pv[0], &yv[0], n, threadN);
+		CYBOZU_BENCH_T(tG2, G2::mulVecMT, QQ, &Qv[0], &yv[0], n, threadN);
+		if (threadN == 1) {
+			t1G1 = tG1;
+			t1G2 = tG2;
+		}
+		printf("thread %3d G1 %12.2f usec x%5.2f G2 %12.2f usec x%5.2f\n", (int)threadN, tG1, t1G1 / tG1, tG2, t1G2 / tG2);
+	}
+}
+
+/*
+	BN::pairingVecMT for n = 2^6, ..., 2^maxLogN
+	report the number of pairs per second for the number of threads = 1, 2, 4, ..., maxThreadN
+*/
+void benchPairingVecMT(size_t maxLogN, size_t maxThreadN)
+{
+	using namespace mcl::bn256;
+	puts("benchPairingVecMT");
+#ifndef MCL_USE_OMP
+	puts("MCL_USE_OMP is not defined, then pairingVecMT runs in a single thread");
+#endif
+	initPairing();
+	const size_t maxN = size_t(1) << maxLogN;
+	std::vector<G1> Pv(maxN);
+	std::vector<G2> Qv(maxN);
+	BN::hashAndMapToG1(Pv[0], "abc", 3);
+	BN::hashAndMapToG2(Qv[0], "abc", 3);
+	for (size_t i = 1; i < maxN; i++) {
+		G1::add(Pv[i], Pv[i - 1], Pv[0]);
+		G2::dbl(Qv[i], Qv[i - 1]);
+	}
+	G1::normalizeVec(&Pv[0], &Pv[0], maxN);
+	G2::normalizeVec(&Qv[0], &Qv[0], maxN);
+	Fp12 e;
+	for (size_t logN = 6; logN <= maxLogN; logN += 2) {
+		const size_t n = size_t(1) << logN;
+		double t1 = 0;
+		printf("n=%d\n", (int)n);
+		for (size_t threadN = 1; threadN <= maxThreadN; threadN *= 2) {
+			double t;
+			CYBOZU_BENCH_T(t, BN::pairingVecMT, e, &Pv[0], &Qv[0], n, threadN);
+			if (threadN == 1) t1 = t;
+			printf("thread %3d %12.2f usec %10.1f pairs/sec x%5.2f\n", (int)threadN, t, n * 1e6 / t, t1 / t);
+		}
+	}
+}
+
 int main(int argc, char *argv[])
 	try
 {
@@ -187,6 +323,11 @@ int main(int argc, char *argv[])
 	bool ecOnly;
 	bool fpOnly;
 	bool misc;
+	bool mulVec;
+	bool mulVecMT;
+	bool pairingVecMT;
+	size_t maxLogN;
+	size_t maxThreadN;
 	mcl::ec::Mode ecMode;
 	std::string ecModeStr;
 	cybozu::Option opt;
@@ -195,6 +336,11 @@ int main(int argc, char *argv[])
 	opt.appendBoolOpt(&ecOnly, "ec", ": ec only");
 	opt.appendBoolOpt(&fpOnly, "fp", ": fp only");
 	opt.appendBoolOpt(&misc, "misc", ": other benchmark");
+	opt.appendBoolOpt(&mulVec, "mulvec", ": multi-scalar multiplication benchmark");
+	opt.appendBoolOpt(&mulVecMT, "mulvecmt", ": multi-threaded multi-scalar multiplication benchmark for 2^logn points");
+	opt.appendBoolOpt(&pairingVecMT, "pairingmt", ": multi-threaded multi-pairing benchmark for 2^6, ..., 2^logn pairs");
+	opt.appendOpt(&maxLogN, 20, "logn", ": max log2 of the number of points for mulvec");
+	opt.appendOpt(&maxThreadN, 32, "t", ": max number of threads for mulvecmt and pairingmt");
 	opt.appendOpt(&ecModeStr, "jacobi", "ecmode", ": jacobi or proj");
 	opt.appendHelp("h", ": show this message");
 	if (!opt.parse(argc, argv)) {
@@ -216,7 +362,13 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 	if (mode == 0) mode = 31;
-	if (misc) {
+	if (mulVec) {
+		benchMulVec(maxLogN);
+	} else if (mulVecMT) {
+		benchMulVecMT(maxLogN, maxThreadN);
+	} else if (pairingVecMT) {
+		benchPairingVecMT(maxLogN, maxThreadN);
+	} else if (misc) {
 		benchToStr16();
 		benchFromStr16();
 	} else {
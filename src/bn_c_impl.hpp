@@ -69,10 +69,10 @@ mclSize getStr(void *buf, mclSize maxBufSize, const T *x, int ioMode, const char
 }
 
 template<class T>
-mclSize serialize(void *buf, mclSize maxBufSize, const T *x, const char *msg)
+mclSize serialize(void *buf, mclSize maxBufSize, const T *x, const char *msg, int ioMode = mcl::IoSerialize)
 	try
 {
-	return (mclSize)cast(x)->serialize(buf, maxBufSize);
+	return (mclSize)cast(x)->serialize(buf, maxBufSize, ioMode);
 } catch (std::exception& e) {
 	if (g_fp) fprintf(g_fp, "%s %s\n", msg, e.what());
 	return 0;
@@ -90,10 +90,10 @@ int setStr(T *x, const char *buf, mclSize bufSize, int ioMode, const char *msg)
 }
 
 template<class T>
-mclSize deserialize(T *x, const void *buf, mclSize bufSize, const char *msg)
+mclSize deserialize(T *x, const void *buf, mclSize bufSize, const char *msg, int ioMode = mcl::IoSerialize)
 	try
 {
-	const size_t n = cast(x)->deserialize(buf, bufSize);
+	const size_t n = cast(x)->deserialize(buf, bufSize, ioMode);
 	return (mclSize)n;
 } catch (std::exception& e) {
 	if (g_fp) fprintf(g_fp, "%s %s\n", msg, e.what());
@@ -275,6 +275,10 @@ void mclBnFr_div(mclBnFr *z, const mclBnFr *x, const mclBnFr *y)
 {
 	Fr::div(*cast(z),*cast(x), *cast(y));
 }
+void mclBnFr_invVec(mclBnFr *y, const mclBnFr *x, mclSize n)
+{
+	Fr::invVec(cast(y), cast(x), n);
+}
 
 ////////////////////////////////////////////////
 // set zero
@@ -354,6 +358,10 @@ void mclBnG1_mulCT(mclBnG1 *z, const mclBnG1 *x, const mclBnFr *y)
 {
 	G1::mulCT(*cast(z),*cast(x), *cast(y));
 }
+void mclBnG1_mulVec(mclBnG1 *z, const mclBnG1 *x, const mclBnFr *y, mclSize n)
+{
+	G1::mulVec(*cast(z), cast(x), cast(y), n);
+}
 
 ////////////////////////////////////////////////
 // set zero
@@ -432,6 +440,10 @@ void mclBnG2_mulCT(mclBnG2 *z, const mclBnG2 *x, const mclBnFr *y)
 {
 	G2::mulCT(*cast(z),*cast(x), *cast(y));
 }
+void mclBnG2_mulVec(mclBnG2 *z, const mclBnG2 *x, const mclBnFr *y, mclSize n)
+{
+	G2::mulVec(*cast(z), cast(x), cast(y), n);
+}
 
 ////////////////////////////////////////////////
 // set zero
@@ -482,6 +494,14 @@ mclSize mclBnGT_serialize(void *buf, mclSize maxBufSize, const mclBnGT *x)
 {
 	return serialize(buf, maxBufSize, x, "mclBnGT_serialize");
 }
+mclSize mclBnGT_serializeTorus(void *buf, mclSize maxBufSize, const mclBnGT *x)
+{
+	return serialize(buf, maxBufSize, x, "mclBnGT_serializeTorus", mcl::IoSerialize | mcl::IoTorus);
+}
+mclSize mclBnGT_deserializeTorus(mclBnGT *x, const void *buf, mclSize bufSize)
+{
+	return deserialize(x, buf, bufSize, "mclBnGT_deserializeTorus", mcl::IoSerialize | mcl::IoTorus);
+}
 
 void mclBnGT_neg(mclBnGT *y, const mclBnGT *x)
 {
@@ -511,6 +531,10 @@ void mclBnGT_div(mclBnGT *z, const mclBnGT *x, const mclBnGT *y)
 {
 	Fp12::div(*cast(z),*cast(x), *cast(y));
 }
+void mclBnGT_invVec(mclBnGT *y, const mclBnGT *x, mclSize n)
+{
+	Fp12::invVec(cast(y), cast(x), n);
+}
 
 void mclBnGT_pow(mclBnGT *z, const mclBnGT *x, const mclBnFr *y)
 {
@@ -533,6 +557,10 @@ void mclBn_millerLoop(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y)
 {
 	BN::millerLoop(*cast(z), *cast(x), *cast(y));
 }
+void mclBn_millerLoopVec(mclBnGT *z, const mclBnG1 *x, const mclBnG2 *y, mclSize n)
+{
+	BN::millerLoopVec(*cast(z), cast(x), cast(y), n);
+}
 int mclBn_getUint64NumToPrecompute(void)
 {
 	return int(BN::param.precomputedQcoeffSize * sizeof(Fp6) / sizeof(uint64_t));
@@ -552,6 +580,10 @@ void mclBn_precomputedMillerLoop2(mclBnGT *f, const mclBnG1 *P1, const uint64_t
 {
 	BN::precomputedMillerLoop2(*cast(f), *cast(P1), cast(Q1buf), *cast(P2), cast(Q2buf));
 }
+void mclBn_precomputedMillerLoopVec(mclBnGT *f, const mclBnG1 *P, const uint64_t *Qbuf, mclSize n)
+{
+	BN::precomputedMillerLoopVec(*cast(f), cast(P), cast(Qbuf), n);
+}
 
 int mclBn_FrLagrangeInterpolation(mclBnFr *out, const mclBnFr *xVec, const mclBnFr *yVec, mclSize k)
 	try
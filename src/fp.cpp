@@ -7,6 +7,7 @@
 #endif
 #include <cybozu/endian.hpp>
 #include "conversion.hpp"
+#include "safegcd.hpp"
 #ifdef MCL_USE_XBYAK
 #include "fp_generator.hpp"
 #endif
@@ -269,6 +270,34 @@ static inline void fp_invOpC(Unit *y, const Unit *x, const Op& op)
 #endif
 }
 
+/*
+	return the Legendre symbol (x/p)
+	R = 2^(N * UnitBitSize) is a square so (xR/p) = (x/p)
+	and x need not be converted from Montgomery form
+*/
+static int fp_legendreC(const Unit *x, const Op& op)
+{
+	const int N = (int)op.N;
+#ifdef MCL_USE_VINT
+	Vint vx, vp;
+	vx.setArray(x, N);
+	vp.setArray(op.p, N);
+	return Vint::jacobi(vx, vp);
+#else
+	mpz_t mx, mp;
+	set_mpz_t(mx, x, N);
+	set_mpz_t(mp, op.p, N);
+	return mpz_legendre(mx, mp);
+#endif
+}
+
+static int fp_legendreSafeGcd(const Unit *x, const Op& op)
+{
+	int v = safegcd::legendre(x, op);
+	if (v) return v;
+	return fp_legendreC(x, op);
+}
+
 /*
 	inv(xR) = (1/x)R^-1 -toMont-> 1/x -toMont-> (1/x)R
 */
@@ -278,6 +307,15 @@ static void fp_invMontOpC(Unit *y, const Unit *x, const Op& op)
 	op.fp_mul(y, y, op.R3, op.p);
 }
 
+/*
+	y = 1/x if !isMont
+	y = R^2/(xR) = (1/x)R if isMont
+*/
+static void fp_invSafeGcdOp(Unit *y, const Unit *x, const Op& op)
+{
+	safegcd::inv(y, x, op.isMont ? op.R2 : op.one, op);
+}
+
 /*
 	large (N * 2) specification of AddPre, SubPre
 */
@@ -335,6 +373,7 @@ void setOp2(Op& op)
 	op.fp_addPre = AddPre<N, Tag>::f;
 	op.fp_subPre = SubPre<N, Tag>::f;
 	op.fp2_mulNF = Fp2MulNF<N, Tag>::f;
+	op.fp2_sqrNF = Fp2SqrNF<N, Tag>::f;
 	SetFpDbl<N, enableFpDbl>::exec(op);
 }
 
@@ -345,11 +384,6 @@ void setOp(Op& op, Mode mode)
 	op.fp_isZero = isZeroC<N>;
 	op.fp_clear = clearC<N>;
 	op.fp_copy = copyC<N>;
-	if (op.isMont) {
-		op.fp_invOp = fp_invMontOpC;
-	} else {
-		op.fp_invOp = fp_invOpC;
-	}
 	setOp2<N, Gtag, true, false>(op);
 #ifdef MCL_USE_LLVM
 	if (mode != fp::FP_GMP && mode != fp::FP_GMP_MONT) {
@@ -419,13 +453,12 @@ static void initForMont(Op& op, const Unit *p, Mode mode)
 	op.fg->init(op);
 
 	if (op.isMont && N <= 4) {
-		op.fp_invOp = &invOpForMontC;
 		initInvTbl(op);
 	}
 #endif
 }
 
-void Op::init(const std::string& mstr, size_t maxBitSize, Mode mode, size_t mclMaxBitSize)
+void Op::init(const std::string& mstr, size_t maxBitSize, Mode mode, InvMode invMode, size_t mclMaxBitSize)
 {
 	if (mclMaxBitSize != MCL_MAX_BIT_SIZE) {
 		throw cybozu::Exception("Op:init:mismatch between header and library of MCL_MAX_BIT_SIZE") << mclMaxBitSize << MCL_MAX_BIT_SIZE;
@@ -458,7 +491,7 @@ void Op::init(const std::string& mstr, size_t maxBitSize, Mode mode, size_t mclM
 */
 #ifdef MCL_USE_XBYAK
 	if (mode == FP_AUTO) mode = FP_XBYAK;
-	if (mode == FP_XBYAK && bitSize > 256) {
+	if (mode == FP_XBYAK && !FpGenerator::isSupported(bitSize)) {
 		mode = FP_AUTO;
 	}
 	if (!isEnableJIT()) {
@@ -549,6 +582,8 @@ void Op::init(const std::string& mstr, size_t maxBitSize, Mode mode, size_t mclM
 	}
 #endif
 	fp::initForMont(*this, p, mode);
+	setInvMode(invMode);
+	fp_legendre = fp_legendreSafeGcd;
 	sq.set(mp);
 	if (N * UnitBitSize <= 256) {
 		hash = sha256;
@@ -557,6 +592,33 @@ void Op::init(const std::string& mstr, size_t maxBitSize, Mode mode, size_t mclM
 	}
 }
 
+void Op::setInvMode(InvMode invMode)
+{
+	switch (invMode) {
+	case INV_AUTO:
+#ifdef MCL_USE_XBYAK
+		if (!invTbl.empty()) {
+			fp_invOp = &invOpForMontC;
+			return;
+		}
+#endif
+#ifdef MCL_USE_VINT
+		fp_invOp = fp_invSafeGcdOp;
+#else
+		fp_invOp = isMont ? fp_invMontOpC : fp_invOpC;
+#endif
+		return;
+	case INV_GMP:
+		fp_invOp = isMont ? fp_invMontOpC : fp_invOpC;
+		return;
+	case INV_SAFEGCD:
+		fp_invOp = fp_invSafeGcdOp;
+		return;
+	default:
+		throw cybozu::Exception("Op:setInvMode:bad mode") << invMode;
+	}
+}
+
 void arrayToStr(std::string& str, const Unit *x, size_t n, int ioMode)
 {
 	int base = ioMode & ~IoPrefix;
@@ -173,6 +173,24 @@ struct FpGenerator : Xbyak::CodeGenerator {
 		useMulx_ = cpu_.has(Xbyak::util::Cpu::tBMI2);
 		useAdx_ = cpu_.has(Xbyak::util::Cpu::tADX);
 	}
+	/*
+		return true if init() supports a prime of bitSize
+		256 < bitSize <= 512 requires mulx, adox and adcx
+	*/
+	static bool isSupported(size_t bitSize)
+	{
+		if (bitSize <= 256) return true;
+		if (bitSize > 512) return false;
+		Xbyak::util::Cpu cpu;
+		return cpu.has(Xbyak::util::Cpu::tBMI2) && cpu.has(Xbyak::util::Cpu::tADX);
+	}
+	/*
+		use mulx, adox and adcx kernels for 4 < pn_ <= 8
+	*/
+	bool isLargeN() const
+	{
+		return 4 < pn_ && pn_ <= 8 && useMulx_ && useAdx_;
+	}
 	/*
 		@param op [in] ; use op.p, op.N, op.isFullBit
 	*/
@@ -229,8 +247,9 @@ struct FpGenerator : Xbyak::CodeGenerator {
 			gen_preInv();
 		}
 		// setup fp_tower
-		if (op.N > 4) return;
+		if (op.N > 4 && !isLargeN()) return;
 		op.fp2_mulNF = 0;
+		op.fp2_sqrNF = 0;
 		align(16);
 		op.fpDbl_add = getCurr<void4u>();
 		gen_fpDbl_add();
@@ -248,21 +267,29 @@ struct FpGenerator : Xbyak::CodeGenerator {
 			op.fpDbl_subPre = getCurr<u3u>();
 			gen_addSubPre(false, pn_ * 2);
 		}
-		if (op.N == 2 || op.N == 3 || op.N == 4) {
+		if (op.N == 2 || op.N == 3 || op.N == 4 || isLargeN()) {
 			align(16);
 			op.fpDbl_mod = getCurr<void3u>();
 			gen_fpDbl_mod(op);
 		}
-		if ((useMulx_ && op.N == 2) || op.N == 3 || op.N == 4 || (useAdx_ && op.N == 6)) {
+		if ((useMulx_ && op.N == 2) || op.N == 3 || op.N == 4 || isLargeN()) {
 			align(16);
 			op.fpDbl_mulPre = getCurr<void3u>();
 			gen_fpDbl_mulPre();
 		}
-		if ((useMulx_ && op.N == 2) || op.N == 3 || op.N == 4) {
+		if ((useMulx_ && op.N == 2) || op.N == 3 || op.N == 4 || isLargeN()) {
 			align(16);
 			op.fpDbl_sqrPre = getCurr<void2u>();
 			gen_fpDbl_sqrPre(op);
 		}
+		if (useMulx_ && useAdx_ && 4 <= op.N && op.N <= 6 && !isFullBit_) {
+			align(16);
+			op.fp2_mulNF = getCurr<void4u>();
+			gen_fp2_mulNF();
+			align(16);
+			op.fp2_sqrNF = getCurr<void3u>();
+			gen_fp2_sqrNF();
+		}
 	}
 	void gen_addSubPre(bool isAdd, int n)
 	{
@@ -472,6 +499,54 @@ struct FpGenerator : Xbyak::CodeGenerator {
 		add_rr(p0, p1);
 		store_mr(pz, p0);
 	}
+	/*
+		pz[] = px[] + py[] mod p[] for pn_ > 4
+		pz[] keeps px[] + py[] while p[] is subtracted
+		use t[0..pn_] (+ t[pn_ + 1] if isFullBit_)
+	*/
+	void gen_raw_fp_add_large(const RegExp& pz, const RegExp& px, const RegExp& py, const Pack& t, bool withCarry)
+	{
+		const Pack z = t.sub(0, pn_);
+		const Reg64& pp = t[pn_];
+		const Reg64 *fullReg = isFullBit_ ? &t[pn_ + 1] : 0;
+		load_rm(z, px);
+		add_rm(z, py, withCarry);
+		if (fullReg) {
+			mov(*fullReg, 0);
+			adc(*fullReg, 0);
+		}
+		store_mr(pz, z);
+		mov(pp, (size_t)p_);
+		sub_rm(z, pp);
+		if (fullReg) {
+			sbb(*fullReg, 0);
+		}
+		for (int i = 0; i < pn_; i++) {
+			cmovc(z[i], ptr [pz + i * 8]);
+		}
+		store_mr(pz, z);
+	}
+	/*
+		pz[] = px[] - py[] mod p[] for pn_ > 4
+		pz[] keeps px[] - py[] while p[] is added
+		use rax, t[0..pn_]
+	*/
+	void gen_raw_fp_sub_large(const RegExp& pz, const RegExp& px, const RegExp& py, const Pack& t, bool withCarry)
+	{
+		const Pack z = t.sub(0, pn_);
+		const Reg64& pp = t[pn_];
+		load_rm(z, px);
+		sub_rm(z, py, withCarry);
+		sbb(rax, rax); // rax = (x > y) ? 0 : -1
+		store_mr(pz, z);
+		mov(pp, (size_t)p_);
+		add_rm(z, pp);
+		test(rax, rax);
+		for (int i = 0; i < pn_; i++) {
+			cmovz(z[i], ptr [pz + i * 8]);
+		}
+		store_mr(pz, z);
+	}
 	void gen_fp_add_le4()
 	{
 		assert(pn_ <= 4);
@@ -535,25 +610,34 @@ struct FpGenerator : Xbyak::CodeGenerator {
 	}
 	void gen_fpDbl_add()
 	{
-		assert(pn_ <= 4);
-		int tn = pn_ * 2 + (isFullBit_ ? 1 : 0);
+		const bool isLarge = pn_ > 4;
+		int tn = isLarge ? pn_ + 1 : pn_ * 2;
+		if (isFullBit_) tn++;
 		StackFrame sf(this, 3, tn);
 		const Reg64& pz = sf.p[0];
 		const Reg64& px = sf.p[1];
 		const Reg64& py = sf.p[2];
 		gen_raw_add(pz, px, py, rax, pn_);
-		gen_raw_fp_add(pz + 8 * pn_, px + 8 * pn_, py + 8 * pn_, sf.t, true);
+		if (isLarge) {
+			gen_raw_fp_add_large(pz + 8 * pn_, px + 8 * pn_, py + 8 * pn_, sf.t, true);
+		} else {
+			gen_raw_fp_add(pz + 8 * pn_, px + 8 * pn_, py + 8 * pn_, sf.t, true);
+		}
 	}
 	void gen_fpDbl_sub()
 	{
-		assert(pn_ <= 4);
-		int tn = pn_ * 2;
+		const bool isLarge = pn_ > 4;
+		int tn = isLarge ? pn_ + 1 : pn_ * 2;
 		StackFrame sf(this, 3, tn);
 		const Reg64& pz = sf.p[0];
 		const Reg64& px = sf.p[1];
 		const Reg64& py = sf.p[2];
 		gen_raw_sub(pz, px, py, rax, pn_);
-		gen_raw_fp_sub(pz + 8 * pn_, px + 8 * pn_, py + 8 * pn_, sf.t, true);
+		if (isLarge) {
+			gen_raw_fp_sub_large(pz + 8 * pn_, px + 8 * pn_, py + 8 * pn_, sf.t, true);
+		} else {
+			gen_raw_fp_sub(pz + 8 * pn_, px + 8 * pn_, py + 8 * pn_, sf.t, true);
+		}
 	}
 	void gen_fp_sub()
 	{
@@ -611,6 +695,8 @@ struct FpGenerator : Xbyak::CodeGenerator {
 			gen_montMul3(p_, rp_);
 		} else if (pn_ == 4) {
 			gen_montMul4(p_, rp_);
+		} else if (isLargeN()) {
+			gen_montMulLarge();
 		} else if (pn_ <= 9) {
 			gen_montMulN(p_, rp_, pn_);
 		} else {
@@ -911,6 +997,16 @@ struct FpGenerator : Xbyak::CodeGenerator {
 			gen_fpDbl_mod4();
 			break;
 		default:
+			if (isLargeN()) {
+				StackFrame sf(this, 2, (pn_ + 3) | UseRDX, 8);
+				const Reg64& z = sf.p[0];
+				const Reg64& xy = sf.p[1];
+				mov(ptr [rsp], z);
+				Pack t = sf.t;
+				t.append(z);
+				montRedLarge(rsp, xy, t);
+				break;
+			}
 			throw cybozu::Exception("gen_fpDbl_mod:not support") << pn_;
 		}
 	}
@@ -925,6 +1021,10 @@ struct FpGenerator : Xbyak::CodeGenerator {
 			gen_montSqr3(p_, rp_);
 			return;
 		}
+		if (isLargeN()) {
+			gen_montSqrLarge();
+			return;
+		}
 		// sqr(y, x) = mul(y, x, x)
 #ifdef XBYAK64_WIN
 		mov(r8, rdx);
@@ -971,6 +1071,93 @@ struct FpGenerator : Xbyak::CodeGenerator {
 		}
 	L("@@");
 	}
+	/*
+		input (pz[], px[], py[])
+		z[] <- montgomery(x[], y[]) for 4 < n <= 8
+	*/
+	void gen_montMulLarge()
+	{
+		const int n = pn_;
+		StackFrame sf(this, 3, (n + 1) | UseRDX, (n * 2 + 1) * 8);
+		const Reg64& pz = sf.p[0];
+		const Reg64& px = sf.p[1];
+		const Reg64& py = sf.p[2];
+		const RegExp keepZ = rsp + n * 16;
+		mov(ptr [keepZ], pz);
+		mulPreLarge(rsp, px, py, sf.t);
+		Pack t = sf.t;
+		t.append(px).append(py).append(pz);
+		montRedLarge(keepZ, rsp, t);
+	}
+	/*
+		input (py[], px[])
+		y[] <- montgomery(x[], x[]) for 4 < n <= 8
+	*/
+	void gen_montSqrLarge()
+	{
+		const int n = pn_;
+		StackFrame sf(this, 2, (n + 2) | UseRDX, (n * 2 + 1) * 8);
+		const Reg64& py = sf.p[0];
+		const Reg64& px = sf.p[1];
+		const RegExp keepY = rsp + n * 16;
+		mov(ptr [keepY], py);
+		sqrPreLarge(rsp, px, sf.t);
+		Pack t = sf.t;
+		t.append(px).append(py);
+		montRedLarge(keepY, rsp, t);
+	}
+	/*
+		z[n-1..0] <- montgomery reduction(xy[2n-1..0]) where n = pn_
+		pz : memory which keeps the address of z
+		xy is not modified and may be overlapped with z
+		use rax, rdx, t[0..n+3]
+	*/
+	void montRedLarge(const RegExp& pz, const RegExp& xy, const Pack& t)
+	{
+		const int n = pn_;
+		Pack w = t.sub(0, n + 1); // w[n..0] = xy[i+n..i]
+		const Reg64& hi = t[n + 1];
+		const Reg64& pp = t[n + 2];
+		const Reg64& c = t[n + 3]; // carry into xy[i+n+1]
+		mov(pp, (size_t)p_);
+		load_rm(w.sub(0, n), xy);
+		xor_(c, c);
+		for (int i = 0; i < n; i++) {
+			mov(rdx, rp_);
+			imul(rdx, w[0]); // q = w[0] * rp
+			xor_(eax, eax); // clear CF and OF
+			mov(w[n], ptr [xy + (i + n) * 8]);
+			// [c:w[n..0]] += p * q where w[0] becomes 0
+			mulx(hi, rax, ptr [pp]);
+			adox(w[0], rax);
+			for (int j = 1; j < n; j++) {
+				adcx(w[j], hi);
+				mulx(hi, rax, ptr [pp + j * 8]);
+				adox(w[j], rax);
+			}
+			adcx(w[n], hi);
+			adox(w[n], c);
+			if (i < n - 1 || isFullBit_) {
+				mov(c, 0);
+				adcx(c, c);
+				mov(eax, 0);
+				adox(c, rax);
+			}
+			Pack next = w.sub(1);
+			next.append(w[0]);
+			w = next;
+		}
+		// z = w < p ? w : w - p
+		const Pack z = w.sub(0, n);
+		mov(rdx, ptr [pz]);
+		store_mr(rdx, z);
+		sub_rm(z, pp);
+		if (isFullBit_) sbb(c, 0);
+		for (int i = 0; i < n; i++) {
+			cmovc(z[i], ptr [rdx + i * 8]);
+		}
+		store_mr(rdx, z);
+	}
 	/*
 		input (z, x, y) = (p0, p1, p2)
 		z[0..3] <- montgomery(x[0..3], y[0..3])
@@ -1249,6 +1436,7 @@ struct FpGenerator : Xbyak::CodeGenerator {
 	{
 		const Reg64& a = rax;
 		const Reg64& d = rdx;
+		xor_(a, a); // clear CF and OF
 		mov(d, ptr [px]);
 		mulx(hi, a, ptr [py + 8 * 0]);
 		adox(pd[0], a);
@@ -1565,23 +1753,70 @@ struct FpGenerator : Xbyak::CodeGenerator {
 		mov(ptr [pz + 8 * 7], d);
 #endif
 	}
-	void mulPre6(const RegExp& pz, const RegExp& px, const RegExp& py, const Pack& t)
+	/*
+		pz[2n-1..0] <- px[n-1..0] * py[n-1..0] where n = pn_
+		use rax, rdx, t[0..n]
+	*/
+	void mulPreLarge(const RegExp& pz, const RegExp& px, const RegExp& py, const Pack& t)
 	{
+		const int n = pn_;
+		Pack pd = t.sub(0, n);
+		const Reg64 *hi = &t[n];
+		mulPack(pz, px, py, pd);
+		for (int i = 1; i < n; i++) {
+			mulPackAdd(pz + 8 * i, px + 8 * i, py, *hi, pd);
+			const Reg64 *next = &pd[0];
+			pd = pd.sub(1);
+			pd.append(*hi);
+			hi = next;
+		}
+		store_mr(pz + 8 * n, pd);
+	}
+	/*
+		py[2n-1..0] <- px[n-1..0] ^ 2 where n = pn_
+		use rax, rdx, t[0..n-1]
+	*/
+	void sqrPreLarge(const RegExp& py, const RegExp& px, const Pack& t)
+	{
+		const int n = pn_;
+		// py[2n-2..1] <- sum_{i < j} x[i] x[j]
+		Pack pd = t.sub(0, n - 1);
+		const Reg64 *hi = &t[n - 1];
+		mulPack(py + 8, px, px + 8, pd);
+		for (int i = 1; i < n - 1; i++) {
+			mov(ptr [py + 8 * (i * 2)], pd[0]);
+			const Reg64 *next = &pd[0];
+			pd = pd.sub(1);
+			mulPackAdd(py + 8 * (i * 2 + 1), px + 8 * i, px + 8 * (i + 1), *hi, pd);
+			pd = pd.sub(1);
+			pd.append(*hi);
+			hi = next;
+		}
+		mov(ptr [py + 8 * (n * 2 - 2)], pd[0]);
+		// py[] <- py[] * 2 + sum_i x[i]^2
 		const Reg64& t0 = t[0];
 		const Reg64& t1 = t[1];
-		const Reg64& t2 = t[2];
-		const Reg64& t3 = t[3];
-		const Reg64& t4 = t[4];
-		const Reg64& t5 = t[5];
-		const Reg64& t6 = t[6];
-
-		mulPack(pz, px, py, Pack(t5, t4, t3, t2, t1, t0)); // [t5:t4:t3:t2:t1:t0]
-		mulPackAdd(pz + 8 * 1, px + 8 * 1, py, t6, Pack(t5, t4, t3, t2, t1, t0)); // [t6:t5:t4:t3:t2:t1]
-		mulPackAdd(pz + 8 * 2, px + 8 * 2, py, t0, Pack(t6, t5, t4, t3, t2, t1)); // [t0:t6:t5:t4:t3:t2]
-		mulPackAdd(pz + 8 * 3, px + 8 * 3, py, t1, Pack(t0, t6, t5, t4, t3, t2)); // [t1:t0:t6:t5:t4:t3]
-		mulPackAdd(pz + 8 * 4, px + 8 * 4, py, t2, Pack(t1, t0, t6, t5, t4, t3)); // [t2:t1:t0:t6:t5:t4]
-		mulPackAdd(pz + 8 * 5, px + 8 * 5, py, t3, Pack(t2, t1, t0, t6, t5, t4)); // [t3:t2:t1:t0:t6:t5]
-		store_mr(pz + 8 * 6, Pack(t3, t2, t1, t0, t6, t5));
+		xor_(eax, eax); // clear CF and OF
+		for (int i = 0; i < n; i++) {
+			mov(rdx, ptr [px + 8 * i]);
+			mulx(t1, rax, rdx);
+			if (i == 0) {
+				mov(ptr [py], rax);
+			} else {
+				mov(t0, ptr [py + 8 * (i * 2)]);
+				adcx(t0, t0);
+				adox(t0, rax);
+				mov(ptr [py + 8 * (i * 2)], t0);
+			}
+			if (i < n - 1) {
+				mov(t0, ptr [py + 8 * (i * 2 + 1)]);
+			} else {
+				mov(t0, 0);
+			}
+			adcx(t0, t0);
+			adox(t0, t1);
+			mov(ptr [py + 8 * (i * 2 + 1)], t0);
+		}
 	}
 	void gen_fpDbl_sqrPre(mcl::fp::Op& op)
 	{
@@ -1600,6 +1835,11 @@ struct FpGenerator : Xbyak::CodeGenerator {
 			sqrPre4(sf.p[0], sf.p[1], sf.t);
 			return;
 		}
+		if (isLargeN()) {
+			StackFrame sf(this, 2, pn_ | UseRDX);
+			sqrPreLarge(sf.p[0], sf.p[1], sf.t);
+			return;
+		}
 #ifdef XBYAK64_WIN
 		mov(r8, rdx);
 #else
@@ -1618,13 +1858,76 @@ struct FpGenerator : Xbyak::CodeGenerator {
 		} else if (pn_ == 4) {
 			StackFrame sf(this, 3, 10 | UseRDX);
 			mulPre4(sf.p[0], sf.p[1], sf.p[2], sf.t);
-#if 0 // slow?
-		} else if (pn_ == 6 && useAdx_) {
-			StackFrame sf(this, 3, 7 | UseRDX);
-			mulPre6(sf.p[0], sf.p[1], sf.p[2], sf.t);
-#endif
+		} else if (isLargeN()) {
+			StackFrame sf(this, 3, (pn_ + 1) | UseRDX);
+			mulPreLarge(sf.p[0], sf.p[1], sf.p[2], sf.t);
 		}
 	}
+	/*
+		input (pz[], px[], py[]) ; x = a + bi, y = c + di
+		z = (ac - bd) + ((a + b)(c + d) - ac - bd)i
+		three mulPre and two montRed without reduction between them
+		assume 4 <= n <= 6 and !isFullBit_
+	*/
+	void gen_fp2_mulNF()
+	{
+		const int n = pn_;
+		const int FpByte = n * 8;
+		const RegExp keepZ0 = rsp;
+		const RegExp keepZ1 = rsp + 8;
+		const RegExp s = rsp + 16;
+		const RegExp t = s + FpByte;
+		const RegExp d0 = t + FpByte;
+		const RegExp d1 = d0 + FpByte * 2;
+		const RegExp d2 = d1 + FpByte * 2;
+		StackFrame sf(this, 3, (n + 4) | UseRDX, 16 + FpByte * 8);
+		const Reg64& pz = sf.p[0];
+		const Reg64& px = sf.p[1];
+		const Reg64& py = sf.p[2];
+		mov(ptr [keepZ0], pz);
+		lea(rax, ptr [pz + FpByte]);
+		mov(ptr [keepZ1], rax);
+		gen_raw_add(s, px, px + FpByte, rax, n); // a + b
+		gen_raw_add(t, py, py + FpByte, rax, n); // c + d
+		mulPreLarge(d0, s, t, sf.t);
+		mulPreLarge(d1, px, py, sf.t); // ac
+		mulPreLarge(d2, px + FpByte, py + FpByte, sf.t); // bd
+		gen_raw_sub(d0, d0, d1, rax, n * 2);
+		gen_raw_sub(d0, d0, d2, rax, n * 2); // ad + bc
+		montRedLarge(keepZ1, d0, sf.t);
+		gen_raw_sub(d1, d1, d2, rax, n);
+		gen_raw_fp_sub_large(d1 + FpByte, d1 + FpByte, d2 + FpByte, sf.t, true); // ac - bd
+		montRedLarge(keepZ0, d1, sf.t);
+	}
+	/*
+		input (py[], px[]) ; x = a + bi
+		y = (a + b)(a - b) + 2abi
+		assume 4 <= n <= 6 and !isFullBit_
+	*/
+	void gen_fp2_sqrNF()
+	{
+		const int n = pn_;
+		const int FpByte = n * 8;
+		const RegExp keepY0 = rsp;
+		const RegExp keepY1 = rsp + 8;
+		const RegExp s = rsp + 16;
+		const RegExp t = s + FpByte;
+		const RegExp d0 = t + FpByte;
+		const RegExp d1 = d0 + FpByte * 2;
+		StackFrame sf(this, 2, (n + 4) | UseRDX, 16 + FpByte * 6);
+		const Reg64& py = sf.p[0];
+		const Reg64& px = sf.p[1];
+		mov(ptr [keepY0], py);
+		lea(rax, ptr [py + FpByte]);
+		mov(ptr [keepY1], rax);
+		gen_raw_add(s, px, px + FpByte, rax, n); // a + b
+		gen_raw_fp_sub_large(t, px, px + FpByte, sf.t, false); // a - b
+		mulPreLarge(d0, s, t, sf.t);
+		gen_raw_add(s, px, px, rax, n); // 2a
+		mulPreLarge(d1, s, px + FpByte, sf.t);
+		montRedLarge(keepY0, d0, sf.t);
+		montRedLarge(keepY1, d1, sf.t);
+	}
 	static inline void debug_put_inner(const uint64_t *ptr, int n)
 	{
 		printf("debug ");
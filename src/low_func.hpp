@@ -537,6 +537,20 @@ struct MontRed {
 template<size_t N, class Tag>
 const void3u MontRed<N, Tag>::f = MontRed<N, Tag>::func;
 
+/*
+	use MulPre (SqrPre) and MontRed for Montgomery multiplication (squaring)
+	instead of the interleaved loop of MulUnitPre
+	it is 10-25% faster for N = 6, 8 (384, 512-bit p) with GMP
+*/
+template<size_t N>
+struct MontUsePre {
+#if MCL_MAX_BIT_SIZE == 1024 || MCL_SIZEOF_UNIT == 4 // check speed
+	static const bool value = true;
+#else
+	static const bool value = N > 4;
+#endif
+};
+
 /*
 	z[N] <- Montgomery(x[N], y[N], p[N])
 	REMARK : assume p[-1] = rp
@@ -545,11 +559,12 @@ template<size_t N, bool isFullBit, class Tag = Gtag>
 struct Mont {
 	static inline void func(Unit *z, const Unit *x, const Unit *y, const Unit *p)
 	{
-#if MCL_MAX_BIT_SIZE == 1024 || MCL_SIZEOF_UNIT == 4 // check speed
-		Unit xy[N * 2];
-		MulPre<N, Tag>::f(xy, x, y);
-		MontRed<N, Tag>::f(z, xy, p);
-#else
+		if (MontUsePre<N>::value) {
+			Unit xy[N * 2];
+			MulPre<N, Tag>::f(xy, x, y);
+			MontRed<N, Tag>::f(z, xy, p);
+			return;
+		}
 		const Unit rp = p[-1];
 		if (isFullBit) {
 			Unit buf[N * 2 + 2];
@@ -616,7 +631,6 @@ struct Mont {
 				memcpy(z, c, N * sizeof(Unit));
 			}
 		}
-#endif
 	}
 	static const void4u f;
 };
@@ -629,13 +643,13 @@ template<size_t N, bool isFullBit, class Tag = Gtag>
 struct SqrMont {
 	static inline void func(Unit *y, const Unit *x, const Unit *p)
 	{
-#if MCL_MAX_BIT_SIZE == 1024 || MCL_SIZEOF_UNIT == 4 // check speed
-		Unit xx[N * 2];
-		SqrPre<N, Tag>::f(xx, x);
-		MontRed<N, Tag>::f(y, xx, p);
-#else
+		if (MontUsePre<N>::value) {
+			Unit xx[N * 2];
+			SqrPre<N, Tag>::f(xx, x);
+			MontRed<N, Tag>::f(y, xx, p);
+			return;
+		}
 		Mont<N, isFullBit, Tag>::f(y, x, x, p);
-#endif
 	}
 	static const void3u f;
 };
@@ -699,6 +713,35 @@ struct Fp2MulNF {
 template<size_t N, class Tag>
 const void4u Fp2MulNF<N, Tag>::f = Fp2MulNF<N, Tag>::func;
 
+/*
+	x = a + bi, i^2 = -1
+	y = x^2 = (a + b)(a - b) + 2abi
+	one Montgomery reduction for each coefficient
+	assume p < R / 2
+*/
+template<size_t N, class Tag = Gtag>
+struct Fp2SqrNF {
+	static inline void func(Unit *y, const Unit *x, const Unit *p)
+	{
+		const Unit *const a = x;
+		const Unit *const b = x + N;
+		Unit d0[N * 2];
+		Unit d1[N * 2];
+		Unit s[N];
+		Unit t[N];
+		AddPre<N, Tag>::f(s, a, b);
+		Sub<N, false, Tag>::f(t, a, b, p);
+		MulPre<N, Tag>::f(d0, s, t); // (a + b)(a - b)
+		AddPre<N, Tag>::f(s, a, a);
+		MulPre<N, Tag>::f(d1, s, b); // 2ab
+		MontRed<N, Tag>::f(y, d0, p);
+		MontRed<N, Tag>::f(y + N, d1, p);
+	}
+	static const void3u f;
+};
+template<size_t N, class Tag>
+const void3u Fp2SqrNF<N, Tag>::f = Fp2SqrNF<N, Tag>::func;
+
 } } // mcl::fp
 
 #ifdef _WIN32
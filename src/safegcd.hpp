@@ -0,0 +1,316 @@
+#pragma once
+/**
+	@file
+	@brief constant-time modular inversion by divsteps
+	@author MITSUNARI Shigeo(@herumi)
+	@license modified new BSD license
+	http://opensource.org/licenses/BSD-3-Clause
+
+	ref. D. J. Bernstein and B.-Y. Yang, Fast constant-time gcd computation and modular inversion
+	https://eprint.iacr.org/2019/266
+	the layout follows the signed62 variant of libsecp256k1 generalized to N Units
+*/
+#include <mcl/op.hpp>
+#include <cybozu/bit_operation.hpp>
+
+namespace mcl { namespace fp { namespace safegcd {
+
+/*
+	a value is represented as L signed limbs of W bits
+	the top limb holds the sign
+*/
+#if MCL_SIZEOF_UNIT == 8 && defined(__SIZEOF_INT128__)
+typedef int64_t Int;
+typedef uint64_t UInt;
+typedef __int128 DInt;
+const size_t W = 62;
+#else
+typedef int32_t Int;
+typedef uint32_t UInt;
+typedef int64_t DInt;
+const size_t W = 30;
+#endif
+const size_t IntBitSize = sizeof(Int) * 8;
+const UInt M = UInt(-1) >> (IntBitSize - W);
+const size_t maxLimbSize = maxUnitSize * UnitBitSize / W + 1;
+
+/*
+	2x2 transition matrix scaled by 2^W
+*/
+struct Trans {
+	Int u, v, q, r;
+};
+
+/*
+	y[0..L) = x[0..n)
+*/
+inline void fromUnit(Int *y, size_t L, const Unit *x, size_t n)
+{
+	for (size_t i = 0; i < L; i++) {
+		const size_t q = (i * W) / UnitBitSize;
+		const size_t r = (i * W) % UnitBitSize;
+		UInt v = 0;
+		if (q < n) {
+			v = UInt(x[q] >> r);
+			if (r + W > UnitBitSize && q + 1 < n) v |= UInt(x[q + 1] << (UnitBitSize - r));
+		}
+		y[i] = Int(v & M);
+	}
+}
+
+/*
+	y[0..n) = x[0..L)
+	assume 0 <= x[i] < 2^W
+*/
+inline void toUnit(Unit *y, size_t n, const Int *x, size_t L)
+{
+	for (size_t i = 0; i < n; i++) y[i] = 0;
+	for (size_t i = 0; i < L; i++) {
+		const size_t q = (i * W) / UnitBitSize;
+		const size_t r = (i * W) % UnitBitSize;
+		const Unit v = Unit(UInt(x[i]));
+		if (q < n) y[q] |= v << r;
+		if (r + W > UnitBitSize && q + 1 < n) y[q + 1] |= v >> (UnitBitSize - r);
+	}
+}
+
+/*
+	(W - 3) divsteps on the low bits of f and g
+	zeta = -(delta + 1/2)
+	return new zeta
+*/
+inline Int divsteps(Int zeta, UInt f, UInt g, Trans& t)
+{
+	UInt u = 8, v = 0, q = 0, r = 8;
+	for (size_t i = 3; i < W; i++) {
+		const UInt c1 = UInt(zeta >> (IntBitSize - 1)); // zeta < 0
+		const UInt c2 = UInt(0) - (g & 1);
+		const UInt x = (f ^ c1) - c1;
+		const UInt y = (u ^ c1) - c1;
+		const UInt z = (v ^ c1) - c1;
+		g += x & c2;
+		q += y & c2;
+		r += z & c2;
+		const UInt c3 = c1 & c2;
+		zeta = (zeta ^ Int(c3)) - 1;
+		f += g & c3;
+		u += q & c3;
+		v += r & c3;
+		g >>= 1;
+		u <<= 1;
+		v <<= 1;
+	}
+	t.u = Int(u);
+	t.v = Int(v);
+	t.q = Int(q);
+	t.r = Int(r);
+	return zeta;
+}
+
+/*
+	[d, e] = (t [d, e] + m [md, me]) / 2^W
+	keep d, e in (-2m, m)
+*/
+inline void updateDE(Int *d, Int *e, const Trans& t, const Int *m, UInt mInv, size_t L)
+{
+	const Int u = t.u, v = t.v, q = t.q, r = t.r;
+	const Int sd = d[L - 1] >> (IntBitSize - 1);
+	const Int se = e[L - 1] >> (IntBitSize - 1);
+	Int md = (u & sd) + (v & se);
+	Int me = (q & sd) + (r & se);
+	DInt cd = DInt(u) * d[0] + DInt(v) * e[0];
+	DInt ce = DInt(q) * d[0] + DInt(r) * e[0];
+	md -= Int((mInv * UInt(cd) + UInt(md)) & M);
+	me -= Int((mInv * UInt(ce) + UInt(me)) & M);
+	cd += DInt(m[0]) * md;
+	ce += DInt(m[0]) * me;
+	cd >>= W;
+	ce >>= W;
+	for (size_t i = 1; i < L; i++) {
+		cd += DInt(u) * d[i] + DInt(v) * e[i] + DInt(m[i]) * md;
+		ce += DInt(q) * d[i] + DInt(r) * e[i] + DInt(m[i]) * me;
+		d[i - 1] = Int(UInt(cd) & M);
+		e[i - 1] = Int(UInt(ce) & M);
+		cd >>= W;
+		ce >>= W;
+	}
+	d[L - 1] = Int(cd);
+	e[L - 1] = Int(ce);
+}
+
+/*
+	[f, g] = t [f, g] / 2^W
+*/
+inline void updateFG(Int *f, Int *g, const Trans& t, size_t L)
+{
+	const Int u = t.u, v = t.v, q = t.q, r = t.r;
+	DInt cf = DInt(u) * f[0] + DInt(v) * g[0];
+	DInt cg = DInt(q) * f[0] + DInt(r) * g[0];
+	cf >>= W;
+	cg >>= W;
+	for (size_t i = 1; i < L; i++) {
+		cf += DInt(u) * f[i] + DInt(v) * g[i];
+		cg += DInt(q) * f[i] + DInt(r) * g[i];
+		f[i - 1] = Int(UInt(cf) & M);
+		g[i - 1] = Int(UInt(cg) & M);
+		cf >>= W;
+		cg >>= W;
+	}
+	f[L - 1] = Int(cf);
+	g[L - 1] = Int(cg);
+}
+
+inline void propagate(Int *x, size_t L)
+{
+	for (size_t i = 0; i < L - 1; i++) {
+		x[i + 1] += x[i] >> W;
+		x[i] &= Int(M);
+	}
+}
+
+/*
+	x = (sign < 0 ? -x : x) mod m
+	assume x in (-2m, m)
+*/
+inline void normalize(Int *x, Int sign, const Int *m, size_t L)
+{
+	Int c = x[L - 1] >> (IntBitSize - 1);
+	for (size_t i = 0; i < L; i++) x[i] += m[i] & c;
+	c = sign >> (IntBitSize - 1);
+	for (size_t i = 0; i < L; i++) x[i] = (x[i] ^ c) - c;
+	propagate(x, L);
+	c = x[L - 1] >> (IntBitSize - 1);
+	for (size_t i = 0; i < L; i++) x[i] += m[i] & c;
+	propagate(x, L);
+}
+
+/*
+	y = c / x mod p where p = op.p
+	y = 0 if x = 0
+	the running time depends only on op.bitSize
+*/
+inline void inv(Unit *y, const Unit *x, const Unit *c, const Op& op)
+{
+	const size_t N = op.N;
+	const size_t L = N * UnitBitSize / W + 1;
+	Int m[maxLimbSize], f[maxLimbSize], g[maxLimbSize], d[maxLimbSize], e[maxLimbSize];
+	fromUnit(m, L, op.p, N);
+	fromUnit(g, L, x, N);
+	fromUnit(e, L, c, N);
+	for (size_t i = 0; i < L; i++) {
+		f[i] = m[i];
+		d[i] = 0;
+	}
+	// mInv = 1/p mod 2^W by Newton's method
+	UInt mInv = UInt(op.p[0]);
+	for (int i = 0; i < 5; i++) mInv *= 2 - UInt(op.p[0]) * mInv;
+	/*
+		the number of divsteps bounded for bitSize-bit input
+		ref. https://github.com/sipa/safegcd-bounds
+	*/
+	const size_t stepN = (45907 * op.bitSize + 26313) / 19929;
+	const size_t loopN = (stepN + W - 4) / (W - 3);
+	Int zeta = -1;
+	Trans t;
+	for (size_t i = 0; i < loopN; i++) {
+		zeta = divsteps(zeta, UInt(f[0]), UInt(g[0]), t);
+		updateDE(d, e, t, m, mInv, L);
+		updateFG(f, g, t, L);
+	}
+	// f = 1 or -1
+	normalize(d, f[L - 1], m, L);
+	toUnit(y, N, d, L);
+}
+
+/*
+	W posdivsteps on the low bits of f and g (variable time)
+	f and g are positive and f is odd
+	f mod 2^IntBitSize (not 2^W) is necessary to track f mod 8
+	eta = -delta
+	the lowest bit of jac is flipped iff the Jacobi symbol (g/f) changes the sign
+	return new eta
+	ref. secp256k1_modinv64_posdivsteps_62_var in libsecp256k1
+*/
+inline Int posdivsteps(Int eta, UInt f, UInt g, Trans& t, int& jac)
+{
+	UInt u = 1, v = 0, q = 0, r = 1;
+	int i = int(W);
+	for (;;) {
+		// count zeros up to i with a sentinel bit
+		const int zeros = cybozu::bsf(g | (UInt(-1) << i));
+		g >>= zeros;
+		u <<= zeros;
+		v <<= zeros;
+		eta -= zeros;
+		i -= zeros;
+		// (2/f) = -1 iff f = 3, 5 mod 8
+		jac ^= int(zeros & ((f >> 1) ^ (f >> 2)));
+		if (i == 0) break;
+		int limit;
+		UInt m, w;
+		if (eta < 0) {
+			UInt tmp;
+			eta = -eta;
+			tmp = f; f = g; g = tmp;
+			tmp = u; u = q; q = tmp;
+			tmp = v; v = r; r = tmp;
+			// quadratic reciprocity
+			jac ^= int((f & g) >> 1);
+			// cancel out up to 6 bits of g
+			limit = (int(eta) + 1) > i ? i : (int(eta) + 1);
+			m = (UInt(-1) >> (IntBitSize - limit)) & 63;
+			w = (f * g * (f * f - 2)) & m;
+		} else {
+			// cancel out up to 4 bits of g
+			limit = (int(eta) + 1) > i ? i : (int(eta) + 1);
+			m = (UInt(-1) >> (IntBitSize - limit)) & 15;
+			w = f + (((f + 1) & 4) << 1);
+			w = (UInt(0) - w * g) & m;
+		}
+		g += f * w;
+		q += u * w;
+		r += v * w;
+		assert((g & m) == 0);
+	}
+	t.u = Int(u);
+	t.v = Int(v);
+	t.q = Int(q);
+	t.r = Int(r);
+	return eta;
+}
+
+/*
+	return the Legendre symbol (x/p) where p = op.p
+	return 0 if x = 0 or the loop does not converge
+	(x is not changed by Montgomery form because R is a square)
+*/
+inline int legendre(const Unit *x, const Op& op)
+{
+	const size_t N = op.N;
+	size_t L = N * UnitBitSize / W + 1;
+	Int f[maxLimbSize], g[maxLimbSize];
+	fromUnit(f, L, op.p, N);
+	fromUnit(g, L, x, N);
+	Int c = 0;
+	for (size_t i = 0; i < L; i++) c |= g[i];
+	if (c == 0) return 0;
+	// about 6 posdivsteps per bit are enough in practice (1550 for 256-bit in libsecp256k1)
+	const size_t loopN = (op.bitSize * 6 + W - 1) / W;
+	Int eta = -1;
+	int jac = 0;
+	Trans t;
+	for (size_t n = 0; n < loopN; n++) {
+		eta = posdivsteps(eta, UInt(f[0]) | (UInt(f[1]) << W), UInt(g[0]) | (UInt(g[1]) << W), t, jac);
+		updateFG(f, g, t, L);
+		if (f[0] == 1) {
+			c = 0;
+			for (size_t i = 1; i < L; i++) c |= f[i];
+			// (g/1) = 1
+			if (c == 0) return 1 - 2 * (jac & 1);
+		}
+		if (L > 1 && f[L - 1] == 0 && g[L - 1] == 0) L--;
+	}
+	return 0;
+}
+
+} } } // mcl::fp::safegcd
@@ -86,10 +86,10 @@ int sheInit(int curve, int maxUnitSize)
 }
 
 template<class T>
-mclSize serialize(void *buf, mclSize maxBufSize, const T *x)
+mclSize serialize(void *buf, mclSize maxBufSize, const T *x, int ioMode = mcl::IoSerialize)
 	try
 {
-	return cast(x)->serialize(buf, maxBufSize);
+	return cast(x)->serialize(buf, maxBufSize, ioMode);
 } catch (std::exception& e) {
 	fprintf(stderr, "err %s\n", e.what());
 	return 0;
@@ -120,16 +120,21 @@ mclSize sheCipherTextGTSerialize(void *buf, mclSize maxBufSize, const sheCipherT
 	return serialize(buf, maxBufSize, c);
 }
 
+mclSize sheCipherTextGTSerializeTorus(void *buf, mclSize maxBufSize, const sheCipherTextGT *c)
+{
+	return serialize(buf, maxBufSize, c, mcl::IoSerialize | mcl::IoTorus);
+}
+
 mclSize sheZkpBinSerialize(void *buf, mclSize maxBufSize, const sheZkpBin *zkp)
 {
 	return serialize(buf, maxBufSize, zkp);
 }
 
 template<class T>
-mclSize deserialize(T *x, const void *buf, mclSize bufSize)
+mclSize deserialize(T *x, const void *buf, mclSize bufSize, int ioMode = mcl::IoSerialize)
 	try
 {
-	return cast(x)->deserialize(buf, bufSize);
+	return cast(x)->deserialize(buf, bufSize, ioMode);
 } catch (std::exception& e) {
 	fprintf(stderr, "err %s\n", e.what());
 	return 0;
@@ -160,6 +165,11 @@ mclSize sheCipherTextGTDeserialize(sheCipherTextGT* c, const void *buf, mclSize
 	return deserialize(c, buf, bufSize);
 }
 
+mclSize sheCipherTextGTDeserializeTorus(sheCipherTextGT* c, const void *buf, mclSize bufSize)
+{
+	return deserialize(c, buf, bufSize, mcl::IoSerialize | mcl::IoTorus);
+}
+
 mclSize sheZkpBinDeserialize(sheZkpBin* zkp, const void *buf, mclSize bufSize)
 {
 	return deserialize(zkp, buf, bufSize);
@@ -207,6 +217,29 @@ int sheSetRangeForGTDLP(mclSize hashSize)
 	return setRangeForDLP(SHE::setRangeForGTDLP, hashSize);
 }
 
+static int setKangarooRangeForDLP(void (*f)(size_t, size_t), mclSize bitSize, mclSize tblSize)
+	try
+{
+	f(bitSize, tblSize);
+	return 0;
+} catch (std::exception& e) {
+	fprintf(stderr, "err %s\n", e.what());
+	return -1;
+}
+
+int sheSetKangarooRangeForG1DLP(mclSize bitSize, mclSize tblSize)
+{
+	return setKangarooRangeForDLP(SHE::setKangarooRangeForG1DLP, bitSize, tblSize);
+}
+int sheSetKangarooRangeForG2DLP(mclSize bitSize, mclSize tblSize)
+{
+	return setKangarooRangeForDLP(SHE::setKangarooRangeForG2DLP, bitSize, tblSize);
+}
+int sheSetKangarooRangeForGTDLP(mclSize bitSize, mclSize tblSize)
+{
+	return setKangarooRangeForDLP(SHE::setKangarooRangeForGTDLP, bitSize, tblSize);
+}
+
 void sheSetTryNum(mclSize tryNum)
 {
 	SHE::setTryNum(tryNum);
@@ -243,6 +276,30 @@ mclSize sheLoadTableForGTDLP(const void *buf, mclSize bufSize)
 	return loadTable(SHE::ePQhashTbl_, buf, bufSize);
 }
 
+template<class HashTable>
+int mapTable(HashTable& table, const char *path)
+	try
+{
+	table.loadFile(path);
+	return 0;
+} catch (std::exception& e) {
+	fprintf(stderr, "err %s\n", e.what());
+	return -1;
+}
+
+int sheMapTableForG1DLP(const char *path)
+{
+	return mapTable(SHE::PhashTbl_, path);
+}
+int sheMapTableForG2DLP(const char *path)
+{
+	return mapTable(SHE::QhashTbl_, path);
+}
+int sheMapTableForGTDLP(const char *path)
+{
+	return mapTable(SHE::ePQhashTbl_, path);
+}
+
 template<class HashTable>
 mclSize saveTable(void *buf, mclSize maxBufSize, const HashTable& table)
 	try
@@ -348,6 +405,41 @@ int sheDecGT(mclInt *m, const sheSecretKey *sec, const sheCipherTextGT *c)
 	return decT(m, sec, c);
 }
 
+template<class CT>
+int decVecT(mclInt *m, int *status, const sheSecretKey *sec, const CT *c, mclSize n)
+	try
+{
+	if (n == 0) return 0;
+	std::vector<int64_t> mv(n);
+	// used as the storage of bool[n]
+	std::vector<char> okBuf(n * sizeof(bool));
+	bool *ok = reinterpret_cast<bool*>(&okBuf[0]);
+	bool b = cast(sec)->decVec(&mv[0], ok, cast(c), n);
+	for (size_t i = 0; i < n; i++) {
+		m[i] = mclInt(mv[i]);
+		status[i] = ok[i] ? 0 : -1;
+	}
+	return b ? 0 : -1;
+} catch (std::exception& e) {
+	fprintf(stderr, "err %s\n", e.what());
+	return -1;
+}
+
+int sheDecG1Vec(mclInt *m, int *status, const sheSecretKey *sec, const sheCipherTextG1 *c, mclSize n)
+{
+	return decVecT(m, status, sec, c, n);
+}
+
+int sheDecG2Vec(mclInt *m, int *status, const sheSecretKey *sec, const sheCipherTextG2 *c, mclSize n)
+{
+	return decVecT(m, status, sec, c, n);
+}
+
+int sheDecGTVec(mclInt *m, int *status, const sheSecretKey *sec, const sheCipherTextGT *c, mclSize n)
+{
+	return decVecT(m, status, sec, c, n);
+}
+
 template<class CT>
 int decViaGTT(mclInt *m, const sheSecretKey *sec, const CT *c)
 	try
@@ -472,6 +564,28 @@ int sheMulGT(sheCipherTextGT *z, const sheCipherTextGT *x, mclInt y)
 	return mulT(*cast(z), *cast(x), y);
 }
 
+template<class CT>
+int linearCombinationT(CT& z, const CT *x, const mclInt *w, mclSize n)
+	try
+{
+	std::vector<int64_t> wv(w, w + n);
+	CT::linearCombination(z, x, n ? &wv[0] : 0, n);
+	return 0;
+} catch (std::exception& e) {
+	fprintf(stderr, "err %s\n", e.what());
+	return -1;
+}
+
+int sheLinearCombinationG1(sheCipherTextG1 *z, const sheCipherTextG1 *x, const mclInt *w, mclSize n)
+{
+	return linearCombinationT(*cast(z), cast(x), w, n);
+}
+
+int sheLinearCombinationG2(sheCipherTextG2 *z, const sheCipherTextG2 *x, const mclInt *w, mclSize n)
+{
+	return linearCombinationT(*cast(z), cast(x), w, n);
+}
+
 int sheMul(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y)
 {
 	return mulT(*cast(z), *cast(x), *cast(y));
@@ -497,6 +611,16 @@ int sheFinalExpGT(sheCipherTextGT *y, const sheCipherTextGT *x)
 	return -1;
 }
 
+int sheInnerProduct(sheCipherTextGT *z, const sheCipherTextG1 *x, const sheCipherTextG2 *y, mclSize n)
+	try
+{
+	CipherTextGT::innerProduct(*cast(z), cast(x), cast(y), n);
+	return 0;
+} catch (std::exception& e) {
+	fprintf(stderr, "err %s\n", e.what());
+	return -1;
+}
+
 template<class CT>
 int reRandT(CT& c, const shePublicKey *pub)
 	try
@@ -30,10 +30,24 @@ void testBench(const G1& P, const G2& Q)
 	G2 QQ;
 	CYBOZU_BENCH_C("hashAndMapToG1", C, BN::hashAndMapToG1, PP, "abc", 3);
 	CYBOZU_BENCH_C("hashAndMapToG2", C, BN::hashAndMapToG2, QQ, "abc", 3);
+	const std::string sP = P.getStr(mcl::IoSerialize);
+	const std::string sQ = Q.getStr(mcl::IoSerialize);
+	CYBOZU_BENCH_C("G1::deserialize", C, PP.setStr, sP, mcl::IoSerialize);
+	CYBOZU_BENCH_C("G2::deserialize", C, QQ.setStr, sQ, mcl::IoSerialize);
+	G2::setOrder(0);
+	CYBOZU_BENCH_C("G2::deserializeNoVerify", C, QQ.setStr, sQ, mcl::IoSerialize);
+	G2::setOrder(BN::param.r);
 	CYBOZU_BENCH_C("Fp::add       ", C2, Fp::add, x, x, y);
 	CYBOZU_BENCH_C("Fp::mul       ", C2, Fp::mul, x, x, y);
 	CYBOZU_BENCH_C("Fp::sqr       ", C2, Fp::sqr, x, x);
 	CYBOZU_BENCH_C("Fp::inv       ", C2, Fp::inv, x, x);
+	CYBOZU_BENCH_C("Fp::squareRoot", C, Fp::squareRoot, x, x);
+	CYBOZU_BENCH_C("Fp::legendre  ", C2, Fp::legendre, x);
+	Fp::setInvMode(mcl::fp::INV_GMP);
+	CYBOZU_BENCH_C("Fp::invGMP    ", C2, Fp::inv, x, x);
+	Fp::setInvMode(mcl::fp::INV_SAFEGCD);
+	CYBOZU_BENCH_C("Fp::invSafeGcd", C2, Fp::inv, x, x);
+	Fp::setInvMode(mcl::fp::INV_AUTO);
 
 	CYBOZU_BENCH_C("GT::add       ", C2, GT::add, e1, e1, e2);
 	CYBOZU_BENCH_C("GT::mul       ", C2, GT::mul, e1, e1, e2);
@@ -45,4 +59,40 @@ void testBench(const G1& P, const G2& Q)
 	std::vector<Fp6> Qcoeff;
 	BN::precomputeG2(Qcoeff, Q);
 	CYBOZU_BENCH_C("precomputedML ", C, BN::precomputedMillerLoop, e2, P, Qcoeff);
+	const size_t n = 16;
+	std::vector<G1> Pv(n, P);
+	std::vector<G2> Qv(n, Q);
+	CYBOZU_BENCH_C("millerLoopVec16", C / 10, BN::millerLoopVec, e1, &Pv[0], &Qv[0], n);
+}
+
+/*
+	compare gmp_mont with the JIT for the same curve
+	and restore g_mode of the test
+*/
+void testBenchMode(const mcl::bn::CurveParam& cp)
+{
+#ifdef MCL_USE_XBYAK
+	const mcl::fp::Mode tbl[] = { mcl::fp::FP_GMP_MONT, mcl::fp::FP_XBYAK };
+	const int C = 100;
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		initPairing(cp, tbl[i]);
+		printf("mode=%s\n", mcl::fp::ModeToStr(tbl[i]));
+		G1 P;
+		G2 Q;
+		BN::mapToG1(P, 1);
+		BN::mapToG2(Q, 1);
+		GT e;
+		Fp x, y;
+		x.setHashOf("abc");
+		y.setHashOf("xyz");
+		CYBOZU_BENCH_C("Fp::mul       ", C * 10, Fp::mul, x, x, y);
+		CYBOZU_BENCH_C("Fp::sqr       ", C * 10, Fp::sqr, x, x);
+		CYBOZU_BENCH_C("pairing       ", C, BN::pairing, e, P, Q);
+		CYBOZU_BENCH_C("millerLoop    ", C, BN::millerLoop, e, P, Q);
+		CYBOZU_BENCH_C("finalExp      ", C, BN::finalExp, e, e);
+	}
+	initPairing(cp, g_mode);
+#else
+	(void)cp;
+#endif
 }
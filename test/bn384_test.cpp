@@ -43,6 +43,7 @@ CYBOZU_TEST_AUTO(pairing)
 	testCurve(mcl::bn::CurveFp254BNb);
 	puts("CurveFp382_1");
 	testCurve(mcl::bn::CurveFp382_1);
+	testBenchMode(mcl::bn::CurveFp382_1);
 	puts("CurveFp382_2");
 	testCurve(mcl::bn::CurveFp382_2);
 	// Q is not on EcT, but bad order
@@ -73,6 +73,7 @@ CYBOZU_TEST_AUTO(pairing)
 {
 	puts("CurveFp462");
 	testCurve(mcl::bn::CurveFp462);
+	testBenchMode(mcl::bn::CurveFp462);
 	puts("CurveFp382_1");
 	testCurve(mcl::bn::CurveFp382_1);
 	puts("CurveFp382_2");
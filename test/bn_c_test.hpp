@@ -123,6 +123,17 @@ CYBOZU_TEST_AUTO(Fr)
 	CYBOZU_TEST_EQUAL(size, strlen(buf));
 	CYBOZU_TEST_ASSERT(!mclBnFr_setStr(&y, buf, size, 10));
 	CYBOZU_TEST_ASSERT(mclBnFr_isEqual(&x, &y));
+
+	mclBnFr xv[4], yv[4];
+	for (int i = 0; i < 4; i++) {
+		mclBnFr_setInt(&xv[i], i * 3);
+	}
+	mclBnFr_invVec(yv, xv, 4);
+	CYBOZU_TEST_ASSERT(mclBnFr_isZero(&yv[0]));
+	for (int i = 1; i < 4; i++) {
+		mclBnFr_mul(&x, &xv[i], &yv[i]);
+		CYBOZU_TEST_ASSERT(mclBnFr_isOne(&x));
+	}
 }
 
 CYBOZU_TEST_AUTO(G1)
@@ -163,6 +174,19 @@ CYBOZU_TEST_AUTO(G1)
 	CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&x, &z));
 	mclBnG1_normalize(&y, &z);
 	CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&y, &z));
+
+	mclBnG1 xv[3];
+	mclBnFr yv[3];
+	mclBnG1_clear(&x);
+	for (int i = 0; i < 3; i++) {
+		mclBnFr_setInt(&n, i + 5);
+		mclBnG1_mul(&xv[i], &y, &n);
+		mclBnFr_setInt(&yv[i], i * 7 - 3);
+		mclBnG1_mul(&z, &xv[i], &yv[i]);
+		mclBnG1_add(&x, &x, &z);
+	}
+	mclBnG1_mulVec(&z, xv, yv, 3);
+	CYBOZU_TEST_ASSERT(mclBnG1_isEqual(&x, &z));
 }
 
 CYBOZU_TEST_AUTO(G2)
@@ -203,6 +227,19 @@ CYBOZU_TEST_AUTO(G2)
 	CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&x, &z));
 	mclBnG2_normalize(&y, &z);
 	CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&y, &z));
+
+	mclBnG2 xv[3];
+	mclBnFr yv[3];
+	mclBnG2_clear(&x);
+	for (int i = 0; i < 3; i++) {
+		mclBnFr_setInt(&n, i + 5);
+		mclBnG2_mul(&xv[i], &y, &n);
+		mclBnFr_setInt(&yv[i], i * 7 - 3);
+		mclBnG2_mul(&z, &xv[i], &yv[i]);
+		mclBnG2_add(&x, &x, &z);
+	}
+	mclBnG2_mulVec(&z, xv, yv, 3);
+	CYBOZU_TEST_ASSERT(mclBnG2_isEqual(&x, &z));
 }
 
 CYBOZU_TEST_AUTO(GT)
@@ -261,6 +298,19 @@ CYBOZU_TEST_AUTO(GT)
 	CYBOZU_TEST_EQUAL(size, strlen(buf));
 	CYBOZU_TEST_ASSERT(mclBnGT_isEqual(&x, &z));
 
+	{
+		mclBnGT v[3], w[3];
+		v[0] = x;
+		mclBnGT_clear(&v[1]);
+		v[2] = y;
+		mclBnGT_invVec(w, v, 3);
+		CYBOZU_TEST_ASSERT(mclBnGT_isZero(&w[1]));
+		mclBnGT_mul(&z, &v[0], &w[0]);
+		CYBOZU_TEST_ASSERT(mclBnGT_isOne(&z));
+		mclBnGT_mul(&z, &v[2], &w[2]);
+		CYBOZU_TEST_ASSERT(mclBnGT_isOne(&z));
+	}
+
 	/*
 		can't use mclBnGT_pow because x is not in GT
 	*/
@@ -341,6 +391,19 @@ CYBOZU_TEST_AUTO(precomputed)
 
 	mclBnGT_mul(&e1, &e1, &e2);
 	CYBOZU_TEST_ASSERT(mclBnGT_isEqual(&e1, &f3));
+
+	const mclBnG1 Pv[] = { P1, P2 };
+	const mclBnG2 Qv[] = { Q1, Q2 };
+	mclBn_millerLoopVec(&f3, Pv, Qv, 2);
+	mclBn_finalExp(&f3, &f3);
+	CYBOZU_TEST_ASSERT(mclBnGT_isEqual(&e1, &f3));
+
+	std::vector<uint64_t> Qbuf(size * 2);
+	mclBn_precomputeG2(&Qbuf[0], &Q1);
+	mclBn_precomputeG2(&Qbuf[size], &Q2);
+	mclBn_precomputedMillerLoopVec(&f3, Pv, Qbuf.data(), 2);
+	mclBn_finalExp(&f3, &f3);
+	CYBOZU_TEST_ASSERT(mclBnGT_isEqual(&e1, &f3));
 }
 
 CYBOZU_TEST_AUTO(serialize)
@@ -415,6 +478,42 @@ CYBOZU_TEST_AUTO(serialize)
 
 	n = mclBnG2_serialize(buf, expectSize, &Q1);
 	CYBOZU_TEST_EQUAL(n, expectSize);
+
+	// GT
+	mclBnGT e1, e2;
+	mclBnG1_hashAndMapTo(&P1, "1", 1);
+	mclBn_pairing(&e1, &P1, &Q1);
+	expectSize = G1Size * 12;
+	n = mclBnGT_serialize(buf, sizeof(buf), &e1);
+	CYBOZU_TEST_EQUAL(n, expectSize);
+	ret = mclBnGT_deserialize(&e2, buf, n);
+	CYBOZU_TEST_EQUAL(ret, n);
+	CYBOZU_TEST_ASSERT(mclBnGT_isEqual(&e1, &e2));
+
+	expectSize = G1Size * 6;
+	n = mclBnGT_serializeTorus(buf, sizeof(buf), &e1);
+	CYBOZU_TEST_EQUAL(n, expectSize);
+	memset(&e2, 0, sizeof(e2));
+	ret = mclBnGT_deserializeTorus(&e2, buf, n);
+	CYBOZU_TEST_EQUAL(ret, n);
+	CYBOZU_TEST_ASSERT(mclBnGT_isEqual(&e1, &e2));
+	ret = mclBnGT_deserializeTorus(&e2, buf, n - 1);
+	CYBOZU_TEST_EQUAL(ret, 0);
+	// the default format is not changed
+	n = mclBnGT_serialize(buf, sizeof(buf), &e1);
+	CYBOZU_TEST_EQUAL(n, G1Size * 12);
+
+	mclBnGT_setInt(&e1, 1);
+	n = mclBnGT_serializeTorus(buf, sizeof(buf), &e1);
+	CYBOZU_TEST_EQUAL(n, expectSize);
+	ret = mclBnGT_deserializeTorus(&e2, buf, n);
+	CYBOZU_TEST_EQUAL(ret, n);
+	CYBOZU_TEST_ASSERT(mclBnGT_isOne(&e2));
+
+	// not in the cyclotomic subgroup
+	mclBnGT_setInt(&e1, 2);
+	n = mclBnGT_serializeTorus(buf, sizeof(buf), &e1);
+	CYBOZU_TEST_EQUAL(n, 0);
 }
 
 #if MCLBN_FP_UNIT_SIZE == 6
@@ -144,6 +144,22 @@ void testMapToG2()
 	x.setHashOf("abc");
 	BN::mapToG2(g, Fp2(x, 0));
 	CYBOZU_TEST_ASSERT(g.isValid());
+	for (int i = 1; i < 10; i++) {
+		G2 P, Q1, Q2;
+		BN::param.mapTo.calc<G2, Fp2>(P, Fp2(x, i));
+		G2::mulGeneric(Q1, P, BN::param.mapTo.cofactor);
+		BN::param.mapTo.mulByCofactor(Q2, P);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+		// P is not in G2 with high probability
+		G2 R;
+		G2::mulGeneric(R, P, BN::param.r);
+		CYBOZU_TEST_ASSERT(!R.isZero());
+		CYBOZU_TEST_ASSERT(!P.isValidOrder());
+		CYBOZU_TEST_ASSERT(Q1.isValidOrder());
+		CYBOZU_TEST_EXCEPTION(R.setStr(P.getStr()), cybozu::Exception);
+		R.setStr(Q1.getStr());
+		CYBOZU_TEST_EQUAL(R, Q1);
+	}
 }
 
 void testCyclotomic()
@@ -153,6 +169,19 @@ void testCyclotomic()
 		a.getFp0()[i] = i * i;
 	}
 	BN::mapToCyclotomic(a, a);
+	{
+		Fp12 e1, e2;
+		Fp12::sqr(e1, a);
+		Fp12::sqrCyclotomic(e2, a);
+		CYBOZU_TEST_EQUAL(e1, e2);
+		// a is not of order r
+		const mpz_class tbl[] = { 0, 1, -1, 12345, BN::param.r, -BN::param.p * 7 + 3 };
+		for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+			Fp12::powGeneric(e1, a, tbl[i]);
+			Fp12::powCyclotomic(e2, a, tbl[i]);
+			CYBOZU_TEST_EQUAL(e1, e2);
+		}
+	}
 	Fp12 d;
 	Compress b(d, a);
 	a *= a;
@@ -179,6 +208,32 @@ void testCompress(const G1& P, const G2& Q)
 	CYBOZU_TEST_EQUAL(b, c);
 }
 
+void testTorus(const G1& P, const G2& Q)
+{
+	Fp12 e1, e2;
+	BN::pairing(e1, P, Q);
+	const int tbl[] = { 16, mcl::IoSerialize };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		const int ioMode = tbl[i] | mcl::IoTorus;
+		std::string s = e1.getStr(ioMode);
+		e2.setStr(s, ioMode);
+		CYBOZU_TEST_EQUAL(e1, e2);
+		if (tbl[i] == mcl::IoSerialize) {
+			CYBOZU_TEST_EQUAL(s.size(), Fp::getByteSize() * 6);
+		}
+		Fp12::unitaryInv(e2, e1);
+		e2.setStr(e2.getStr(ioMode), ioMode);
+		CYBOZU_TEST_EQUAL(e1 * e2, 1);
+		e2 = 1;
+		e2.setStr(e2.getStr(ioMode), ioMode);
+		CYBOZU_TEST_ASSERT(e2.isOne());
+	}
+	e2 = -1;
+	CYBOZU_TEST_EXCEPTION(e2.getStr(mcl::IoSerialize | mcl::IoTorus), cybozu::Exception);
+	e2 = 2;
+	CYBOZU_TEST_EXCEPTION(e2.getStr(mcl::IoSerialize | mcl::IoTorus), cybozu::Exception);
+}
+
 void testPrecomputed(const G1& P, const G2& Q)
 {
 	Fp12 e1, e2;
@@ -211,6 +266,59 @@ void testFp12pow(const G1& P, const G2& Q)
 	}
 }
 
+template<class G>
+void testMulVecSub(const G& P)
+{
+	cybozu::XorShift rg;
+	const size_t N = 50;
+	G x[N];
+	Fr y[N];
+	for (size_t i = 0; i < N; i++) {
+		Fr t;
+		t.setRand(rg);
+		G::mul(x[i], P, t);
+		y[i].setRand(rg);
+	}
+	x[3].clear();
+	x[5] = x[4];
+	y[6] = 0;
+	y[7] = -1;
+	const size_t nTbl[] = { 0, 1, 2, 3, 10, N };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(nTbl); i++) {
+		const size_t n = nTbl[i];
+		G z1, z2, t;
+		z1.clear();
+		for (size_t j = 0; j < n; j++) {
+			G::mul(t, x[j], y[j]);
+			z1 += t;
+		}
+		G::mulVec(z2, x, y, n);
+		CYBOZU_TEST_EQUAL(z1, z2);
+	}
+	{
+		// enough points to be split into threads
+		const size_t n = 300;
+		std::vector<G> xv(n);
+		std::vector<Fr> yv(n);
+		for (size_t i = 0; i < n; i++) {
+			xv[i] = x[i % N];
+			yv[i].setRand(rg);
+		}
+		G z1, z2;
+		G::mulVec(z1, &xv[0], &yv[0], n);
+		G::mulVecMT(z2, &xv[0], &yv[0], n, 4);
+		CYBOZU_TEST_EQUAL(z1, z2);
+		G::mulVecMT(z2, &xv[0], &yv[0], n);
+		CYBOZU_TEST_EQUAL(z1, z2);
+	}
+}
+
+void testMulVec(const G1& P, const G2& Q)
+{
+	testMulVecSub(P);
+	testMulVecSub(Q);
+}
+
 void testMillerLoop2(const G1& P1, const G2& Q1)
 {
 	Fp12 e1, e2;
@@ -232,6 +340,66 @@ void testMillerLoop2(const G1& P1, const G2& Q1)
 	CYBOZU_TEST_EQUAL(e1, e2);
 }
 
+void testMillerLoopVec(const G1& P, const G2& Q)
+{
+	const size_t N = 6;
+	G1 Pv[N];
+	G2 Qv[N];
+	std::vector<Fp6> Qcoeff(N * BN::param.precomputedQcoeffSize);
+	cybozu::XorShift rg;
+	for (size_t i = 0; i < N; i++) {
+		Fr r;
+		r.setRand(rg);
+		G1::mul(Pv[i], P, r);
+		r.setRand(rg);
+		G2::mul(Qv[i], Q, r);
+	}
+	Pv[3].clear();
+	Qv[4].clear();
+	for (size_t i = 0; i < N; i++) {
+		BN::precomputeG2(&Qcoeff[i * BN::param.precomputedQcoeffSize], Qv[i]);
+	}
+	for (size_t n = 0; n <= N; n++) {
+		Fp12 f1, f2, e1, e2, t;
+		f1 = 1;
+		e1 = 1;
+		for (size_t i = 0; i < n; i++) {
+			BN::millerLoop(t, Pv[i], Qv[i]);
+			f1 *= t;
+			BN::pairing(t, Pv[i], Qv[i]);
+			e1 *= t;
+		}
+		BN::millerLoopVec(f2, Pv, Qv, n);
+		CYBOZU_TEST_EQUAL(f1, f2);
+		BN::pairingVec(e2, Pv, Qv, n);
+		CYBOZU_TEST_EQUAL(e1, e2);
+		BN::precomputedMillerLoopVec(f2, Pv, Qcoeff, n);
+		BN::finalExp(f2, f2);
+		CYBOZU_TEST_EQUAL(e1, f2);
+	}
+	{
+		// enough pairs to be split into threads
+		const size_t n = 20;
+		std::vector<G1> Pn(n);
+		std::vector<G2> Qn(n);
+		std::vector<Fp6> QnCoeff(n * BN::param.precomputedQcoeffSize);
+		for (size_t i = 0; i < n; i++) {
+			Pn[i] = Pv[i % N];
+			Qn[i] = Qv[(i * 5) % N];
+			BN::precomputeG2(&QnCoeff[i * BN::param.precomputedQcoeffSize], Qn[i]);
+		}
+		Fp12 e1, e2;
+		BN::pairingVec(e1, &Pn[0], &Qn[0], n);
+		BN::pairingVecMT(e2, &Pn[0], &Qn[0], n, 3);
+		CYBOZU_TEST_EQUAL(e1, e2);
+		BN::pairingVecMT(e2, &Pn[0], &Qn[0], n);
+		CYBOZU_TEST_EQUAL(e1, e2);
+		BN::precomputedMillerLoopVecMT(e2, &Pn[0], &QnCoeff[0], n, 3);
+		BN::finalExp(e2, e2);
+		CYBOZU_TEST_EQUAL(e1, e2);
+	}
+}
+
 void testPairing(const G1& P, const G2& Q, const char *eStr)
 {
 	Fp12 e1;
@@ -350,6 +518,7 @@ CYBOZU_TEST_AUTO(naive)
 		return;
 #endif
 		testFp12pow(P, Q);
+		testTorus(P, Q);
 		testIo(P, Q);
 		testTrivial(P, Q);
 		testSetStr(Q);
@@ -360,6 +529,8 @@ CYBOZU_TEST_AUTO(naive)
 		testPairing(P, Q, ts.e);
 		testPrecomputed(P, Q);
 		testMillerLoop2(P, Q);
+		testMillerLoopVec(P, Q);
+		testMulVec(P, Q);
 		testBench(P, Q);
 	}
 	int count = (int)clk.getCount();
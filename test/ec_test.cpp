@@ -407,6 +407,34 @@ sub 2.65usec
 dbl 1.56usec
 mul 499.00usec
 */
+	void normalizeVec() const
+	{
+		const Ec P(Fp(para.gx), Fp(para.gy));
+		const size_t n = 8;
+		Ec x[n], y[n];
+		x[0].clear();
+		x[1] = P;
+		for (size_t i = 2; i < n; i++) {
+			Ec::add(x[i], x[i - 1], x[i - 2] + P);
+		}
+		x[5].clear();
+		Ec::normalizeVec(y, x, n);
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_ASSERT(y[i].isNormalized());
+			CYBOZU_TEST_EQUAL(y[i], x[i]);
+			Ec Q;
+			Ec::normalize(Q, x[i]);
+			if (!Q.isZero()) {
+				CYBOZU_TEST_EQUAL(y[i].x, Q.x);
+				CYBOZU_TEST_EQUAL(y[i].y, Q.y);
+			}
+		}
+		Ec::normalizeVec(x, x, n);
+		for (size_t i = 0; i < n; i++) {
+			CYBOZU_TEST_EQUAL(x[i], y[i]);
+		}
+		Ec::normalizeVec(x, x, 0);
+	}
 	void run() const
 	{
 		cstr();
@@ -419,6 +447,7 @@ mul 499.00usec
 		ioMode();
 		mulCT();
 		compare();
+		normalizeVec();
 	}
 private:
 	Test(const Test&);
@@ -651,6 +651,72 @@ void divBy2Test()
 	}
 }
 
+void invTest()
+{
+	const int tbl[] = { 0, 1, 2, 3, -1, -2 };
+	Fp x, y, z;
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl) + 100; i++) {
+		if (i < CYBOZU_NUM_OF_ARRAY(tbl)) {
+			x = tbl[i];
+		} else {
+			x.setByCSPRNG();
+		}
+		Fp::setInvMode(mcl::fp::INV_GMP);
+		Fp::inv(y, x);
+		Fp::setInvMode(mcl::fp::INV_SAFEGCD);
+		Fp::inv(z, x);
+		if (!x.isZero()) {
+			CYBOZU_TEST_EQUAL(y, z);
+			CYBOZU_TEST_EQUAL(x * z, 1);
+		} else {
+			CYBOZU_TEST_ASSERT(z.isZero());
+		}
+	}
+	Fp::setInvMode(mcl::fp::INV_AUTO);
+	const size_t n = 10;
+	Fp xv[n], yv[n];
+	for (size_t i = 0; i < n; i++) {
+		xv[i] = int(i * i) - 5;
+	}
+	xv[4].clear();
+	Fp::invVec(yv, xv, n);
+	for (size_t i = 0; i < n; i++) {
+		Fp::inv(y, xv[i]);
+		CYBOZU_TEST_EQUAL(yv[i], y);
+	}
+	Fp::invVec(xv, xv, 1);
+	CYBOZU_TEST_EQUAL(xv[0], yv[0]);
+}
+
+void invModeTest(const char *pStr, mcl::fp::Mode mode)
+{
+	Fp::init(pStr, mode, mcl::fp::INV_SAFEGCD);
+	for (int i = 0; i < 10; i++) {
+		Fp x, y;
+		x.setByCSPRNG();
+		Fp::inv(y, x);
+		CYBOZU_TEST_EQUAL(x * y, 1);
+	}
+	Fp::init(pStr, mode);
+}
+
+void legendreTest()
+{
+	const int tbl[] = { 0, 1, 2, 3, -1, -2 };
+	Fp x, y;
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl) + 100; i++) {
+		if (i < CYBOZU_NUM_OF_ARRAY(tbl)) {
+			x = tbl[i];
+		} else {
+			x.setByCSPRNG();
+		}
+		const int v = Fp::legendre(x);
+		CYBOZU_TEST_EQUAL(v, mcl::gmp::legendre(x.getMpz(), Fp::getOp().mp));
+		CYBOZU_TEST_EQUAL(v >= 0, Fp::squareRoot(y, x));
+		CYBOZU_TEST_EQUAL(Fp::legendre(x * x), x.isZero() ? 0 : 1);
+	}
+}
+
 void getStrTest()
 {
 	Fp x(0);
@@ -839,8 +905,15 @@ void sub(mcl::fp::Mode mode)
 #if MCL_MAX_BIT_SIZE >= 384
 
 		// N = 6
+		"0x240026400f3d82b2e42de125b00158405b710818ac00000840046200950400000000001380052e000000000000000013",
 		"0xfffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffeffffffff0000000000000000ffffffff",
 #endif
+#if MCL_MAX_BIT_SIZE >= 512
+
+		// N = 8
+		"0x240480360120023ffffffffff6ff0cf6b7d9bfca0000000000d812908f41c8020ffffffffff6ff66fc6ff687f640000000002401b00840138013",
+		"0xfffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffdc7", // max prime
+#endif
 
 #if MCL_MAX_BIT_SIZE >= 521
 		// N = 9
@@ -870,6 +943,9 @@ void sub(mcl::fp::Mode mode)
 		getUint64Test();
 		getInt64Test();
 		divBy2Test();
+		invTest();
+		invModeTest(pStr, mode);
+		legendreTest();
 		getStrTest();
 		setHashOfTest();
 	}
@@ -141,6 +141,23 @@ void testFp2()
 		CYBOZU_TEST_ASSERT(Fp2::squareRoot(z, y));
 		CYBOZU_TEST_EQUAL(z * z, y);
 	}
+	if (Fp::getOp().pmod4 == 3) {
+		// Fp2 is a field
+		cybozu::XorShift rg;
+		int okN = 0;
+		for (int i = 0; i < 20; i++) {
+			x.a.setRand(rg);
+			x.b.setRand(rg);
+			Fp2::sqr(y, x);
+			CYBOZU_TEST_ASSERT(Fp2::squareRoot(z, y));
+			CYBOZU_TEST_EQUAL(z * z, y);
+			if (Fp2::squareRoot(z, x)) {
+				CYBOZU_TEST_EQUAL(z * z, x);
+				okN++;
+			}
+		}
+		CYBOZU_TEST_ASSERT(0 < okN && okN < 20);
+	}
 }
 
 void testFp6sqr(const Fp2& a, const Fp2& b, const Fp2& c, const Fp6& x)
@@ -342,6 +359,40 @@ void testFpDbl()
 	}
 }
 
+void testInvVec()
+{
+	puts(__FUNCTION__);
+	const size_t n = 5;
+	Fp2 x2[n], y2[n];
+	Fp12 x12[n], y12[n];
+	for (size_t i = 0; i < n; i++) {
+		x2[i].a = int(i * i + 1);
+		x2[i].b = int(i * 3);
+		for (int j = 0; j < 12; j++) {
+			x12[i].getFp0()[j] = int(i * j + j + 1);
+		}
+	}
+	x2[2].clear();
+	x12[0].clear();
+	Fp2::invVec(y2, x2, n);
+	Fp12::invVec(y12, x12, n);
+	for (size_t i = 0; i < n; i++) {
+		if (x2[i].isZero()) {
+			CYBOZU_TEST_ASSERT(y2[i].isZero());
+		} else {
+			CYBOZU_TEST_EQUAL(x2[i] * y2[i], 1);
+		}
+		if (x12[i].isZero()) {
+			CYBOZU_TEST_ASSERT(y12[i].isZero());
+		} else {
+			CYBOZU_TEST_EQUAL(x12[i] * y12[i], 1);
+		}
+	}
+	// in-place
+	Fp2::invVec(y2, y2, n);
+	CYBOZU_TEST_EQUAL_ARRAY(y2, x2, n);
+}
+
 void testIo()
 {
 	int modeTbl[] = { 0, 2, 2 | mcl::IoPrefix, 10, 16, 16 | mcl::IoPrefix, mcl::IoArray, mcl::IoArrayRaw };
@@ -399,6 +450,7 @@ void test(const char *p, mcl::fp::Mode mode)
 	testFpDbl();
 	testFp6();
 	testFp12();
+	testInvVec();
 	testIo();
 }
 
@@ -438,6 +490,7 @@ void testAll()
 		const char *p = tbl[i];
 		printf("prime=%s %d\n", p, (int)(strlen(p) - 2) * 4);
 		test(p, mcl::fp::FP_GMP);
+		test(p, mcl::fp::FP_GMP_MONT);
 #ifdef MCL_USE_LLVM
 		test(p, mcl::fp::FP_LLVM);
 		test(p, mcl::fp::FP_LLVM_MONT);
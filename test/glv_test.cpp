@@ -144,6 +144,23 @@ void testGLV1()
 		glv.mul(P2, P0, ss, true);
 		CYBOZU_TEST_EQUAL(P1, P2);
 	}
+	for (size_t w = 2; w <= glv.maxNafW; w++) {
+		glv.setNafW(w);
+		for (int i = 1; i < 20; i++) {
+			BN::mapToG1(P0, i);
+			Fr s;
+			s.setRand(rg);
+			mpz_class ss = s.getMpz();
+			G1::mulGeneric(P1, P0, ss);
+			glv.mul(P2, P0, ss);
+			CYBOZU_TEST_EQUAL(P1, P2);
+			glv.mul(P2, P0, -ss);
+			CYBOZU_TEST_EQUAL(P1, -P2);
+		}
+	}
+	CYBOZU_TEST_EXCEPTION(glv.setNafW(1), cybozu::Exception);
+	CYBOZU_TEST_EXCEPTION(glv.setNafW(glv.maxNafW + 1), cybozu::Exception);
+	glv.setNafW(5);
 	Fr s;
 	BN::mapToG1(P0, 123);
 	CYBOZU_BENCH_C("Ec::mul", 100, P1 = P0; s.setRand(rg); G1::mulGeneric, P2, P1, s.getMpz());
@@ -178,13 +195,97 @@ void testGLV2()
 		G2::mulGeneric(Q1, Q0, n);
 		glv2.mul(Q2, Q0, n);
 		CYBOZU_TEST_EQUAL(Q1, Q2);
+		glv2.mul(Q2, Q0, n, true);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
 	}
+	G1 P;
+	GT e, e1, e2;
+	BN::mapToG1(P, 1);
+	BN::pairing(e, P, Q0);
+	for (size_t w = 2; w <= glv2.maxNafW; w++) {
+		glv2.setNafW(w);
+		for (int i = 1; i < 10; i++) {
+			mcl::gmp::getRand(n, glv2.m, rg);
+			n %= r;
+			BN::mapToG2(Q0, i);
+			G2::mulGeneric(Q1, Q0, n);
+			glv2.mul(Q2, Q0, n);
+			CYBOZU_TEST_EQUAL(Q1, Q2);
+			glv2.mul(Q2, Q0, -n);
+			CYBOZU_TEST_EQUAL(Q1, -Q2);
+			Fp12::powGeneric(e1, e, n);
+			glv2.pow(e2, e, n);
+			CYBOZU_TEST_EQUAL(e1, e2);
+		}
+	}
+	CYBOZU_TEST_EXCEPTION(glv2.setNafW(1), cybozu::Exception);
+	CYBOZU_TEST_EXCEPTION(glv2.setNafW(glv2.maxNafW + 1), cybozu::Exception);
+	glv2.setNafW(4);
 	Fr s;
 	BN::mapToG2(Q0, 123);
 	CYBOZU_BENCH_C("G2::mul", 1000, Q2 = Q0; s.setRand(rg); G2::mulGeneric, Q2, Q1, s.getMpz());
 	CYBOZU_BENCH_C("G2::glv", 1000, Q1 = Q0; s.setRand(rg); glv2.mul, Q2, Q1, s.getMpz());
 }
 
+template<class G, class GLV, int splitN>
+void testFixedBase1(const G& P, const GLV& glv, size_t winSize)
+{
+	mcl::bn::FixedBaseGLV<G, GLV, splitN> fb;
+	fb.init(P, glv, winSize);
+	const mcl::bn::FixedBaseGLV<G, GLV, splitN> fb2(fb);
+	cybozu::XorShift rg;
+	G Q1, Q2;
+	mpz_class n;
+	const mpz_class& r = BN::param.r;
+	for (int i = -10; i < 10; i++) {
+		G::mulGeneric(Q1, P, i);
+		fb.mul(Q2, int64_t(i));
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+	}
+	const mpz_class tbl[] = { r - 1, r, r + 1, -r + 1, r * 2 + 3 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		G::mulGeneric(Q1, P, tbl[i]);
+		fb.mul(Q2, tbl[i]);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+	}
+	Fr x;
+	for (int i = 0; i < 30; i++) {
+		x.setByCSPRNG();
+		G::mulGeneric(Q1, P, x.getMpz());
+		fb.mul(Q2, x);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+		fb2.mul(Q2, x);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+		mcl::gmp::getRand(n, 64, rg);
+		G::mulGeneric(Q1, P, -n);
+		fb.mul(Q2, -n);
+		CYBOZU_TEST_EQUAL(Q1, Q2);
+	}
+}
+
+void testFixedBase()
+{
+	G1 P;
+	G2 Q;
+	BN::mapToG1(P, 1);
+	BN::mapToG2(Q, 1);
+	mcl::GroupMtoA<Fp12> e;
+	BN::pairing(e, P, Q);
+	const size_t winTbl[] = { 2, 5, 10 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(winTbl); i++) {
+		const size_t w = winTbl[i];
+		testFixedBase1<G1, mcl::bn::GLV1<Fp>, 2>(P, BN::param.glv1, w);
+		testFixedBase1<G2, mcl::bn::GLV2<Fp2>, 4>(Q, BN::param.glv2, w);
+		testFixedBase1<mcl::GroupMtoA<Fp12>, mcl::bn::GLV2<Fp2>, 4>(e, BN::param.glv2, w);
+	}
+	mcl::bn::FixedBaseGLV<G1, mcl::bn::GLV1<Fp>, 2> fb1;
+	CYBOZU_TEST_EXCEPTION(fb1.init(P, BN::param.glv1, 1), cybozu::Exception);
+	fb1.init(P, BN::param.glv1, 10);
+	Fr s;
+	G1 R;
+	CYBOZU_BENCH_C("G1::fixedBase", 1000, s.setByCSPRNG(); fb1.mul, R, s);
+}
+
 CYBOZU_TEST_AUTO(glv)
 {
 	const mcl::bn::CurveParam tbl[] = {
@@ -197,5 +298,6 @@ CYBOZU_TEST_AUTO(glv)
 		initPairing(cp);
 		testGLV1();
 		testGLV2();
+		testFixedBase();
 	}
 }
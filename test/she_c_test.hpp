@@ -65,6 +65,62 @@ CYBOZU_TEST_AUTO(encDec)
 	}
 }
 
+CYBOZU_TEST_AUTO(decVec)
+{
+	sheSecretKey sec;
+	sheSecretKeySetByCSPRNG(&sec);
+	shePublicKey pub;
+	sheGetPublicKey(&pub, &sec);
+
+	const size_t n = 5;
+	const int64_t mTbl[n] = { 3, -5, int64_t(hashSize * tryNum * 4), 0, 12345 };
+	sheCipherTextG1 c1[n];
+	sheCipherTextG2 c2[n];
+	sheCipherTextGT ct[n];
+	for (size_t i = 0; i < n; i++) {
+		sheEncG1(&c1[i], &pub, mTbl[i]);
+		sheEncG2(&c2[i], &pub, mTbl[i]);
+		sheEncGT(&ct[i], &pub, mTbl[i]);
+	}
+	int64_t dec1[n], dec2[n], decT[n];
+	int status1[n], status2[n], statusT[n];
+	CYBOZU_TEST_ASSERT(sheDecG1Vec(dec1, status1, &sec, c1, n) != 0);
+	CYBOZU_TEST_ASSERT(sheDecG2Vec(dec2, status2, &sec, c2, n) != 0);
+	CYBOZU_TEST_ASSERT(sheDecGTVec(decT, statusT, &sec, ct, n) != 0);
+	for (size_t i = 0; i < n; i++) {
+		const int status = i == 2 ? -1 : 0;
+		const int64_t m = i == 2 ? 0 : mTbl[i];
+		CYBOZU_TEST_EQUAL(status1[i], status);
+		CYBOZU_TEST_EQUAL(status2[i], status);
+		CYBOZU_TEST_EQUAL(statusT[i], status);
+		CYBOZU_TEST_EQUAL(dec1[i], m);
+		CYBOZU_TEST_EQUAL(dec2[i], m);
+		CYBOZU_TEST_EQUAL(decT[i], m);
+	}
+	CYBOZU_TEST_EQUAL(sheDecG1Vec(dec1, status1, &sec, c1, 2), 0);
+	CYBOZU_TEST_EQUAL(dec1[1], mTbl[1]);
+}
+
+CYBOZU_TEST_AUTO(kangaroo)
+{
+	sheSecretKey sec;
+	sheSecretKeySetByCSPRNG(&sec);
+	shePublicKey pub;
+	sheGetPublicKey(&pub, &sec);
+
+	const int64_t m = int64_t(1) << 25;
+	sheCipherTextG1 c1;
+	sheEncG1(&c1, &pub, m);
+	int64_t dec = 0;
+	CYBOZU_TEST_ASSERT(sheDecG1(&dec, &sec, &c1) != 0);
+	CYBOZU_TEST_ASSERT(sheSetKangarooRangeForG1DLP(100, 512) != 0);
+	CYBOZU_TEST_EQUAL(sheSetKangarooRangeForG1DLP(27, 512), 0);
+	CYBOZU_TEST_EQUAL(sheDecG1(&dec, &sec, &c1), 0);
+	CYBOZU_TEST_EQUAL(dec, m);
+	CYBOZU_TEST_EQUAL(sheSetKangarooRangeForG1DLP(0, 0), 0);
+	CYBOZU_TEST_ASSERT(sheDecG1(&dec, &sec, &c1) != 0);
+}
+
 CYBOZU_TEST_AUTO(addMul)
 {
 	sheSecretKey sec;
@@ -86,6 +142,33 @@ CYBOZU_TEST_AUTO(addMul)
 	CYBOZU_TEST_EQUAL(dec, m1 * m2);
 }
 
+CYBOZU_TEST_AUTO(linearCombination)
+{
+	sheSecretKey sec;
+	sheSecretKeySetByCSPRNG(&sec);
+	shePublicKey pub;
+	sheGetPublicKey(&pub, &sec);
+
+	const size_t n = 4;
+	const int64_t mTbl[n] = { 3, -5, 7, 0 };
+	const int64_t wTbl[n] = { 100, 20, -30, 12345 };
+	sheCipherTextG1 c1[n], z1;
+	sheCipherTextG2 c2[n], z2;
+	int64_t v = 0;
+	for (size_t i = 0; i < n; i++) {
+		sheEncG1(&c1[i], &pub, mTbl[i]);
+		sheEncG2(&c2[i], &pub, mTbl[i]);
+		v += mTbl[i] * wTbl[i];
+	}
+	CYBOZU_TEST_EQUAL(sheLinearCombinationG1(&z1, c1, wTbl, n), 0);
+	CYBOZU_TEST_EQUAL(sheLinearCombinationG2(&z2, c2, wTbl, n), 0);
+	int64_t dec;
+	CYBOZU_TEST_EQUAL(sheDecG1(&dec, &sec, &z1), 0);
+	CYBOZU_TEST_EQUAL(dec, v);
+	CYBOZU_TEST_EQUAL(sheDecG2(&dec, &sec, &z2), 0);
+	CYBOZU_TEST_EQUAL(dec, v);
+}
+
 CYBOZU_TEST_AUTO(allOp)
 {
 	sheSecretKey sec;
@@ -214,6 +297,21 @@ CYBOZU_TEST_AUTO(serialize)
 	n2 = sheCipherTextGTSerialize(buf2, sizeof(buf2), &ct2);
 	CYBOZU_TEST_EQUAL(n2, size);
 	CYBOZU_TEST_EQUAL_ARRAY(buf1, buf2, n2);
+
+	// torus representation of each GT
+	size = sizeofFr * 6 * 4;
+	n1 = sheCipherTextGTSerializeTorus(buf1, sizeof(buf1), &ct1);
+	CYBOZU_TEST_EQUAL(n1, size);
+	r = sheCipherTextGTDeserializeTorus(&ct2, buf1, n1 - 1);
+	CYBOZU_TEST_EQUAL(r, 0u);
+	memset(&ct2, 0, sizeof(ct2));
+	r = sheCipherTextGTDeserializeTorus(&ct2, buf1, n1);
+	CYBOZU_TEST_EQUAL(r, n1);
+	size = sizeofFr * 12 * 4;
+	n1 = sheCipherTextGTSerialize(buf1, sizeof(buf1), &ct1);
+	n2 = sheCipherTextGTSerialize(buf2, sizeof(buf2), &ct2);
+	CYBOZU_TEST_EQUAL(n2, size);
+	CYBOZU_TEST_EQUAL_ARRAY(buf1, buf2, n2);
 }
 
 CYBOZU_TEST_AUTO(convert)
@@ -360,6 +458,13 @@ CYBOZU_TEST_AUTO(finalExp)
 	sheFinalExpGT(&ct, &ct);
 	CYBOZU_TEST_EQUAL(sheDecGT(&dec, &sec, &ct), 0);
 	CYBOZU_TEST_EQUAL(dec, (m11 * m21) + (m12 * m22));
+
+	// sheInnerProduct = sheMul(c11, c21) + sheMul(c12, c22)
+	const sheCipherTextG1 x[] = { c11, c12 };
+	const sheCipherTextG2 y[] = { c21, c22 };
+	CYBOZU_TEST_EQUAL(sheInnerProduct(&ct, x, y, 2), 0);
+	CYBOZU_TEST_EQUAL(sheDecGT(&dec, &sec, &ct), 0);
+	CYBOZU_TEST_EQUAL(dec, (m11 * m21) + (m12 * m22));
 }
 
 int g_hashBitSize = 8;
@@ -393,6 +498,20 @@ CYBOZU_TEST_AUTO(saveLoad)
 	CYBOZU_TEST_ASSERT(n2 > 0);
 	CYBOZU_TEST_ASSERT(sheDecGT(&dec, &sec, &ct) == 0);
 	CYBOZU_TEST_EQUAL(dec, m);
+	// map the table file
+	const char *name = g_tableName.empty() ? "she_c_test_table.bin" : g_tableName.c_str();
+	if (g_tableName.empty()) {
+		std::ofstream ofs(name, std::ios::binary);
+		ofs.write(buf.c_str(), n1);
+	}
+	sheSetRangeForGTDLP(1);
+	sheSetTryNum(1);
+	CYBOZU_TEST_ASSERT(sheDecGT(&dec, &sec, &ct) != 0);
+	CYBOZU_TEST_EQUAL(sheMapTableForGTDLP(name), 0);
+	if (g_tableName.empty()) remove(name);
+	CYBOZU_TEST_ASSERT(sheDecGT(&dec, &sec, &ct) == 0);
+	CYBOZU_TEST_EQUAL(dec, m);
+	CYBOZU_TEST_ASSERT(sheMapTableForGTDLP("") != 0);
 }
 
 int main(int argc, char *argv[])
@@ -3,6 +3,7 @@
 #include <cybozu/benchmark.hpp>
 #include <cybozu/xorshift.hpp>
 #include <time.h>
+#include <fstream>
 #include <mcl/she.hpp>
 
 using namespace mcl::she;
@@ -52,6 +53,31 @@ CYBOZU_TEST_AUTO(HashTable)
 	}
 }
 
+CYBOZU_TEST_AUTO(HashTableGiantStep)
+{
+	mcl::she::local::HashTable<G1> hashTbl;
+	G1 P;
+	BN::hashAndMapToG1(P, "abc");
+	const int maxSize = 10;
+	const int tryNum = int(mcl::she::local::maxGiantTblSize) + 1000;
+	hashTbl.init(P, maxSize, tryNum);
+	const int next = maxSize * 2 + 1;
+	const int tbl[] = { 1, 2, 63, 64, 65, 4095, 4096, 4097, 5000, tryNum - 1 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		for (int d = -maxSize; d <= maxSize; d += 5) {
+			const int x = tbl[i] * next + d;
+			G1 xP;
+			G1::mul(xP, P, x);
+			CYBOZU_TEST_EQUAL(hashTbl.log(xP), x);
+			G1::neg(xP, xP);
+			CYBOZU_TEST_EQUAL(hashTbl.log(xP), -x);
+		}
+	}
+	G1 xP;
+	G1::mul(xP, P, tryNum * next);
+	CYBOZU_TEST_EXCEPTION(hashTbl.log(xP), cybozu::Exception);
+}
+
 CYBOZU_TEST_AUTO(GTHashTable)
 {
 	mcl::she::local::HashTable<GT, false> hashTbl;
@@ -78,6 +104,44 @@ CYBOZU_TEST_AUTO(GTHashTable)
 	}
 }
 
+CYBOZU_TEST_AUTO(KangarooTable)
+{
+	const size_t bitSize = 30;
+	const int64_t half = int64_t(1) << (bitSize - 1);
+	mcl::she::local::KangarooTable<SHE::G1> tbl1, tbl2;
+	CYBOZU_TEST_ASSERT(tbl1.empty());
+	tbl1.init(SHE::P_, bitSize, 512);
+	CYBOZU_TEST_ASSERT(!tbl1.empty());
+	std::stringstream ss;
+	tbl1.save(ss);
+	tbl2.load(ss);
+	CYBOZU_TEST_EQUAL(tbl2.getBitSize(), bitSize);
+	CYBOZU_TEST_EQUAL(tbl2.getTblSize(), tbl1.getTblSize());
+	const int64_t xTbl[] = { 0, 1, -1, 12345, -half, half - 1, 0x12345678, -0x1234567 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(xTbl); i++) {
+		const int64_t x = xTbl[i];
+		G1 xP;
+		G1::mul(xP, SHE::P_, x);
+		CYBOZU_TEST_EQUAL(tbl1.log(xP), x);
+		CYBOZU_TEST_EQUAL(tbl2.log(xP), x);
+	}
+	// the smallest bitSize
+	tbl1.init(SHE::P_, 5, 64);
+	for (int64_t x = -16; x < 16; x++) {
+		G1 xP;
+		G1::mul(xP, SHE::P_, x);
+		CYBOZU_TEST_EQUAL(tbl1.log(xP), x);
+	}
+	CYBOZU_TEST_EXCEPTION(tbl1.init(SHE::P_, 4, 4), cybozu::Exception);
+	mcl::she::local::KangarooTable<SHE::GT, false> gtTbl;
+	gtTbl.init(SHE::ePQ_, 24, 256);
+	for (int64_t x = -(1 << 23); x < (1 << 23); x += 1234567) {
+		GT e;
+		GT::pow(e, SHE::ePQ_, x);
+		CYBOZU_TEST_EQUAL(gtTbl.log(e), x);
+	}
+}
+
 CYBOZU_TEST_AUTO(enc_dec)
 {
 	SecretKey& sec = g_sec;
@@ -122,6 +186,101 @@ CYBOZU_TEST_AUTO(enc_dec)
 	}
 }
 
+template<class CT>
+void testDecVec(const SecretKey& sec, const PublicKey& pub)
+{
+	const int n = 30;
+	const int64_t outOfRange = 1000000000;
+	std::vector<CT> c(n);
+	std::vector<int64_t> m(n);
+	for (int i = 0; i < n; i++) {
+		m[i] = (i % 7 == 6) ? outOfRange : i * 37 - 500;
+		pub.enc(c[i], m[i]);
+	}
+	for (size_t cpuN = 0; cpuN < 4; cpuN++) {
+		std::vector<int64_t> d(n);
+		bool ok[n];
+		CYBOZU_TEST_ASSERT(!sec.decVec(&d[0], ok, &c[0], n, cpuN));
+		for (int i = 0; i < n; i++) {
+			if (m[i] == outOfRange) {
+				CYBOZU_TEST_ASSERT(!ok[i]);
+				CYBOZU_TEST_EQUAL(d[i], 0);
+			} else {
+				CYBOZU_TEST_ASSERT(ok[i]);
+				CYBOZU_TEST_EQUAL(d[i], m[i]);
+			}
+		}
+		CYBOZU_TEST_ASSERT(sec.decVec(&d[0], ok, &c[0], 6, cpuN));
+		CYBOZU_TEST_EQUAL(d[5], m[5]);
+	}
+}
+
+CYBOZU_TEST_AUTO(decVec)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	testDecVec<CipherTextG1>(sec, pub);
+	testDecVec<CipherTextG2>(sec, pub);
+	testDecVec<CipherTextGT>(sec, pub);
+	testDecVec<CipherText>(sec, pub);
+	SHE::useDecG1ViaGT();
+	testDecVec<CipherTextG1>(sec, pub);
+	SHE::useDecG1ViaGT(false);
+}
+
+CYBOZU_TEST_AUTO(decKangaroo)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	const int64_t m = int64_t(1) << 25;
+	CipherTextG1 c1;
+	CipherTextG2 c2;
+	CipherTextGT ct;
+	pub.enc(c1, m);
+	pub.enc(c2, -m);
+	pub.enc(ct, m + 1);
+	CYBOZU_TEST_EXCEPTION(sec.dec(c1), cybozu::Exception);
+	SHE::setKangarooRangeForG1DLP(27, 512);
+	SHE::setKangarooRangeForG2DLP(27, 512);
+	SHE::setKangarooRangeForGTDLP(27, 512);
+	CYBOZU_TEST_EQUAL(sec.dec(c1), m);
+	CYBOZU_TEST_EQUAL(sec.dec(c2), -m);
+	CYBOZU_TEST_EQUAL(sec.dec(ct), m + 1);
+	// the hash table is used first
+	pub.enc(c1, 123);
+	CYBOZU_TEST_EQUAL(sec.dec(c1), 123);
+	SHE::setKangarooRangeForG1DLP(0);
+	SHE::setKangarooRangeForG2DLP(0);
+	SHE::setKangarooRangeForGTDLP(0);
+	pub.enc(c1, m);
+	CYBOZU_TEST_EXCEPTION(sec.dec(c1), cybozu::Exception);
+}
+
+CYBOZU_TEST_AUTO(PrecomputedPublicKeyWinSize)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	PrecomputedPublicKey ppub;
+	ppub.init(pub);
+	const size_t defaultSize = ppub.getTblByteSize();
+	ppub.init(pub, 4);
+	CYBOZU_TEST_ASSERT(ppub.getTblByteSize() < defaultSize);
+	CipherTextG1 c1;
+	CipherTextG2 c2;
+	CipherTextGT ct;
+	for (int i = -5; i < 5; i++) {
+		ppub.enc(c1, i);
+		CYBOZU_TEST_EQUAL(sec.dec(c1), i);
+		ppub.enc(c2, i);
+		CYBOZU_TEST_EQUAL(sec.dec(c2), i);
+		ppub.enc(ct, i);
+		CYBOZU_TEST_EQUAL(sec.dec(ct), i);
+	}
+}
+
 template<class CT, class PK>
 void ZkpBinTest(const SecretKey& sec, const PK& pub)
 {
@@ -304,6 +463,36 @@ CYBOZU_TEST_AUTO(innerProduct)
 		c.add(t);
 	}
 	CYBOZU_TEST_EQUAL(innerProduct, sec.dec(c));
+	/*
+		innerProduct of CipherTextG1 and CipherTextG2 with one finalExp
+	*/
+	const size_t n2 = 150;
+	std::vector<CipherTextG1> x(n2);
+	std::vector<CipherTextG2> y(n2);
+	CipherTextGT ct, ct2, tt;
+	ct2.clear();
+	int64_t v = 0;
+	for (size_t i = 0; i < n2; i++) {
+		const int a = int(rg() % 7) - 3;
+		const int b = int(rg() % 5);
+		v += a * b;
+		pub.enc(x[i], a);
+		pub.enc(y[i], b);
+		CipherTextGT::mul(tt, x[i], y[i]);
+		ct2.add(tt);
+	}
+	for (size_t cpuN = 0; cpuN < 3; cpuN++) {
+		CipherTextGT::innerProduct(ct, &x[0], &y[0], n2, cpuN);
+		CYBOZU_TEST_ASSERT(ct == ct2);
+		CYBOZU_TEST_EQUAL(sec.dec(ct), v);
+	}
+	CipherTextGT::innerProductML(ct, &x[0], &y[0], 10);
+	CipherTextGT::innerProductML(tt, &x[10], &y[10], n2 - 10);
+	ct.add(tt);
+	CipherTextGT::finalExp(ct, ct);
+	CYBOZU_TEST_ASSERT(ct == ct2);
+	CipherTextGT::innerProduct(ct, &x[0], &y[0], 0);
+	CYBOZU_TEST_EQUAL(sec.dec(ct), 0);
 }
 
 template<class T>
@@ -350,6 +539,62 @@ CYBOZU_TEST_AUTO(io)
 	}
 }
 
+template<class CT>
+void naiveLinearCombination(CT& z, const CT *x, const int64_t *w, size_t n)
+{
+	CT t;
+	z.clear();
+	for (size_t i = 0; i < n; i++) {
+		CT::mul(t, x[i], w[i]);
+		z.add(t);
+	}
+}
+
+template<class CT>
+void testLinearCombination(const SecretKey& sec, const PublicKey& pub)
+{
+	cybozu::XorShift rg;
+	const size_t n = 300;
+	std::vector<CT> x(n);
+	std::vector<int64_t> w(n);
+	for (size_t i = 0; i < n; i++) {
+		w[i] = int64_t(int32_t(rg()));
+		pub.enc(x[i], int64_t(rg() % 5) - 2);
+	}
+	w[3] = 0;
+	w[5] = -0x7fffffffffffffffll;
+	CT z1, z2;
+	naiveLinearCombination(z1, &x[0], &w[0], n);
+	for (size_t cpuN = 0; cpuN < 3; cpuN++) {
+		CT::linearCombination(z2, &x[0], &w[0], n, cpuN);
+		CYBOZU_TEST_ASSERT(z1 == z2);
+	}
+	const size_t m = 10;
+	std::vector<int64_t> w2(m);
+	int64_t v2 = 0;
+	for (size_t i = 0; i < m; i++) {
+		w2[i] = int64_t(i) * 1000 - 3000;
+		pub.enc(x[i], int64_t(i));
+		v2 += int64_t(i) * w2[i];
+	}
+	CT::linearCombination(z2, &x[0], &w2[0], m);
+	CYBOZU_TEST_EQUAL(sec.dec(z2), v2);
+	CT::linearCombination(z2, &x[0], &w2[0], 0);
+	CYBOZU_TEST_EQUAL(sec.dec(z2), 0);
+	const int C = 10;
+	CYBOZU_BENCH_C("naive", C, naiveLinearCombination<CT>, z1, &x[0], &w[0], n);
+	CYBOZU_BENCH_C("linearCombination", C, CT::linearCombination, z2, &x[0], &w[0], n, 1);
+}
+
+CYBOZU_TEST_AUTO(linearCombination)
+{
+	const SecretKey& sec = g_sec;
+	PublicKey pub;
+	sec.getPublicKey(pub);
+	testLinearCombination<CipherTextG1>(sec, pub);
+	testLinearCombination<CipherTextG2>(sec, pub);
+}
+
 CYBOZU_TEST_AUTO(bench)
 {
 	const SecretKey& sec = g_sec;
@@ -376,6 +621,97 @@ CYBOZU_TEST_AUTO(saveHash)
 	hashTbl1.save(ss);
 	hashTbl2.load(ss);
 	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	// the table does not depend on the number of threads
+	hashTbl1.init(SHE::P_, 5000, 123, 1);
+	hashTbl2.init(SHE::P_, 5000, 123, 3);
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	mcl::she::local::HashTable<SHE::GT, false> gtTbl1, gtTbl2;
+	gtTbl1.init(SHE::ePQ_, 3000, 123, 1);
+	gtTbl2.init(SHE::ePQ_, 3000, 123, 2);
+	CYBOZU_TEST_ASSERT(gtTbl1 == gtTbl2);
+	for (int i = -3000; i <= 3000; i += 99) {
+		SHE::GT e;
+		SHE::GT::pow(e, SHE::ePQ_, i);
+		CYBOZU_TEST_EQUAL(gtTbl2.log(e), i);
+	}
+}
+
+CYBOZU_TEST_AUTO(loadOldHash)
+{
+	/*
+		the old format ; sorted KeyCount[] of xP for 1 <= x <= hashSize
+	*/
+	const size_t hashSize = 1234;
+	std::vector<mcl::she::local::KeyCount> kcv(hashSize);
+	G1 xP;
+	xP.clear();
+	for (size_t i = 0; i < hashSize; i++) {
+		xP += SHE::P_;
+		G1 T = xP;
+		T.normalize();
+		const int x = int(i + 1);
+		kcv[i].key = uint32_t(*T.x.getUnit());
+		kcv[i].count = T.y.isOdd() ? x : -x;
+	}
+	std::stable_sort(kcv.begin(), kcv.end());
+	std::stringstream ss;
+	cybozu::save(ss, mcl::bn_current::BN::param.curveType);
+	cybozu::writeChar(ss, '1');
+	cybozu::save(ss, kcv.size());
+	cybozu::write(ss, &kcv[0], sizeof(kcv[0]) * kcv.size());
+	SHE::P_.save(ss);
+	mcl::she::local::HashTable<SHE::G1> hashTbl1, hashTbl2;
+	hashTbl1.load(ss);
+	for (int i = -3000; i <= 3000; i += 7) {
+		G1::mul(xP, SHE::P_, i);
+		CYBOZU_TEST_EQUAL(hashTbl1.log(xP), i);
+	}
+	// saved in the new format
+	std::stringstream ss2;
+	hashTbl1.save(ss2);
+	hashTbl2.load(ss2);
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+}
+
+CYBOZU_TEST_AUTO(mapHash)
+{
+	typedef mcl::she::local::HashTable<SHE::G1> HashTable;
+	HashTable hashTbl1, hashTbl2, hashTbl3;
+	hashTbl1.init(SHE::P_, 1234, 123);
+	std::string buf;
+	buf.resize(1234 * 8 + 1024);
+	const size_t n = hashTbl1.save(&buf[0], buf.size());
+	CYBOZU_TEST_ASSERT(n > 0);
+	// the buckets are aligned to the cache line from the top
+	std::vector<uint64_t> aligned((n + 63) / 8);
+	char *top = (char*)&aligned[0];
+	top += (64 - uintptr_t(top) % 64) % 64;
+	memcpy(top, &buf[0], n);
+	CYBOZU_TEST_EQUAL(hashTbl2.loadView(top, n), n);
+	CYBOZU_TEST_ASSERT(hashTbl2.isView());
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl2);
+	CYBOZU_TEST_EXCEPTION(hashTbl3.loadView(top + 64, n), cybozu::Exception);
+	CYBOZU_TEST_EXCEPTION(hashTbl3.loadView(top, n - 1), cybozu::Exception);
+	const char *name = "she_test_hash.bin";
+	{
+		std::ofstream ofs(name, std::ios::binary);
+		ofs.write(buf.c_str(), n);
+	}
+	hashTbl3.loadFile(name);
+	remove(name);
+	CYBOZU_TEST_ASSERT(hashTbl3.isView());
+	CYBOZU_TEST_ASSERT(hashTbl1 == hashTbl3);
+	hashTbl3.setTryNum(123);
+	G1 xP;
+	for (int i = -3000; i <= 3000; i += 7) {
+		G1::mul(xP, SHE::P_, i);
+		CYBOZU_TEST_EQUAL(hashTbl3.log(xP), i);
+	}
+	// a copy owns the buckets
+	HashTable hashTbl4 = hashTbl3;
+	CYBOZU_TEST_ASSERT(!hashTbl4.isView());
+	CYBOZU_TEST_ASSERT(hashTbl3 == hashTbl4);
+	CYBOZU_TEST_EXCEPTION(hashTbl4.loadFile(name), cybozu::Exception);
 }
 
 static inline void putK(double t) { printf("%.2e\n", t * 1e-3); }
@@ -1,4 +1,5 @@
 #include <mcl/gmp_util.hpp>
+#include <mcl/fp.hpp>
 #include <cybozu/test.hpp>
 #include <iostream>
 
@@ -19,3 +20,24 @@ CYBOZU_TEST_AUTO(sqrt)
 		}
 	}
 }
+
+CYBOZU_TEST_AUTO(sqrtFp)
+{
+	typedef mcl::FpT<> Fp;
+	// p = 3 mod 4, 5 mod 8, 1 mod 8
+	const int tbl[] = { 3, 5, 7, 11, 13, 17, 19, 29, 41, 257, 997, 1031, 7681 };
+	for (size_t i = 0; i < CYBOZU_NUM_OF_ARRAY(tbl); i++) {
+		const mpz_class p = tbl[i];
+		Fp::init(p.get_str());
+		const mcl::SquareRoot& sq = Fp::getOp().sq;
+		for (int a = 0; a < tbl[i]; a++) {
+			mpz_class x;
+			bool b = sq.get(x, a);
+			Fp y;
+			CYBOZU_TEST_EQUAL(Fp::squareRoot(y, a), b);
+			if (b) {
+				CYBOZU_TEST_EQUAL(y * y, a);
+			}
+		}
+	}
+}